@@ -0,0 +1,551 @@
+/**
+ * 全接口负载基准测试
+ *
+ * 按脚本化的流量比例（注册、登录、帖子列表、帖子详情、发帖、回复、点赞）对服务施压，
+ * 统计每个接口的吞吐量和延迟分位数（p50/p99/p999），以JSON输出，用于性能回归对比
+ *
+ * 可先向本地MySQL灌入合成数据（1万/10万/100万帖子），对比不同数据量下的表现；
+ * 灌数据是增量的，已有帖子数达到目标时跳过
+ *
+ * 使用:
+ *   ./bench/api_load_bench [--参数=值 ...]
+ *   ./bench/api_load_bench --seed=100k --db-password=your_password
+ *   ./bench/api_load_bench --concurrency=128 --seconds=60 --output=report_100k.json
+ *
+ * 参数:
+ *   --url           服务地址（默认 http://127.0.0.1:8080）
+ *   --concurrency   并发客户端数（默认 64）
+ *   --seconds       压测时长（默认 30）
+ *   --threads       客户端事件循环线程数（默认 4）
+ *   --mix           流量比例（默认 register:1,login:4,list:35,detail:35,create:5,reply:10,like:10）
+ *   --seed          灌入数据量 none/10k/100k/1m（默认 none）
+ *   --users         压测用户数（默认 1000，灌数据时创建 bench_user_0..N-1，密码均为 123456）
+ *   --db-host / --db-port / --db-name / --db-user / --db-password  MySQL连接，灌数据时使用
+ *   --output        报告额外写入的文件
+ */
+
+#include "../utils/LatencyHistogram.h"
+#include "../utils/PasswordUtil.h"
+#include <drogon/drogon.h>
+#include <trantor/net/EventLoopThread.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace drogon;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const BENCH_PASSWORD = "123456";
+
+// 灌数据时每条INSERT的行数
+const int SEED_BATCH = 1000;
+
+enum Route { REGISTER, LOGIN, LIST, DETAIL, CREATE, REPLY, LIKE, ROUTE_COUNT };
+
+const char* const ROUTE_NAMES[ROUTE_COUNT] = {
+    "register", "login", "list", "detail", "create", "reply", "like"
+};
+
+struct BenchOptions {
+    std::string url = "http://127.0.0.1:8080";
+    int concurrency = 64;
+    int seconds = 30;
+    int threads = 4;
+    std::string mix = "register:1,login:4,list:35,detail:35,create:5,reply:10,like:10";
+    std::string seed = "none";
+    int users = 1000;
+    std::string dbHost = "127.0.0.1";
+    int dbPort = 3306;
+    std::string dbName = "college_bbs";
+    std::string dbUser = "root";
+    std::string dbPassword;
+    std::string output;
+};
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    std::map<std::string, std::string> values;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("参数格式应为 --名称=值: " + arg);
+        }
+        values[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+    }
+
+    BenchOptions opt;
+    auto take = [&values](const char* key, auto& field) {
+        auto it = values.find(key);
+        if (it == values.end()) {
+            return;
+        }
+        std::istringstream in(it->second);
+        if (!(in >> field)) {
+            throw std::invalid_argument(std::string("参数值无效: --") + key);
+        }
+        values.erase(it);
+    };
+    take("url", opt.url);
+    take("concurrency", opt.concurrency);
+    take("seconds", opt.seconds);
+    take("threads", opt.threads);
+    take("mix", opt.mix);
+    take("seed", opt.seed);
+    take("users", opt.users);
+    take("db-host", opt.dbHost);
+    take("db-port", opt.dbPort);
+    take("db-name", opt.dbName);
+    take("db-user", opt.dbUser);
+    take("db-password", opt.dbPassword);
+    take("output", opt.output);
+
+    if (!values.empty()) {
+        throw std::invalid_argument("未知参数: --" + values.begin()->first);
+    }
+    if (opt.concurrency < 1 || opt.seconds < 1 || opt.threads < 1 || opt.users < 1) {
+        throw std::invalid_argument("concurrency/seconds/threads/users 必须大于0");
+    }
+    return opt;
+}
+
+/**
+ * 解析流量比例，如 "list:35,detail:35"（未列出的接口权重为0）
+ */
+std::array<double, ROUTE_COUNT> parseMix(const std::string& mix) {
+    std::array<double, ROUTE_COUNT> weights{};
+    std::istringstream in(mix);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        auto colon = item.find(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("流量比例格式应为 接口:权重: " + item);
+        }
+        auto name = item.substr(0, colon);
+        int route = 0;
+        while (route < ROUTE_COUNT && name != ROUTE_NAMES[route]) {
+            route++;
+        }
+        if (route == ROUTE_COUNT) {
+            throw std::invalid_argument("未知接口: " + name);
+        }
+        weights[route] = std::stod(item.substr(colon + 1));
+    }
+    if (std::accumulate(weights.begin(), weights.end(), 0.0) <= 0) {
+        throw std::invalid_argument("流量比例的权重之和必须大于0");
+    }
+    return weights;
+}
+
+int64_t seedPostCount(const std::string& seed) {
+    if (seed == "none") return 0;
+    if (seed == "10k") return 10000;
+    if (seed == "100k") return 100000;
+    if (seed == "1m") return 1000000;
+    throw std::invalid_argument("--seed 只能是 none/10k/100k/1m");
+}
+
+std::string benchUsername(int index) {
+    return "bench_user_" + std::to_string(index);
+}
+
+// ============================================
+// 灌数据
+// ============================================
+
+/**
+ * 向MySQL灌入合成数据
+ * 用户 bench_user_0..N-1；帖子补足到目标数量；每个新帖子附带约1条回复和1个点赞，
+ * 最后重新计算帖子的回复数和点赞数
+ */
+void seedDatabase(const BenchOptions& opt, int64_t targetPosts) {
+    std::string connInfo = "host=" + opt.dbHost + " port=" + std::to_string(opt.dbPort) +
+                           " dbname=" + opt.dbName + " user=" + opt.dbUser;
+    if (!opt.dbPassword.empty()) {
+        connInfo += " password=" + opt.dbPassword;
+    }
+    auto db = orm::DbClient::newMysqlClient(connInfo, 1);
+    std::mt19937 rng(42);
+
+    // 用户（所有压测用户共用一个密码哈希，避免逐个计算）
+    auto hash = PasswordUtil::hashPassword(BENCH_PASSWORD);
+    for (int start = 0; start < opt.users; start += SEED_BATCH) {
+        std::string sql = "INSERT IGNORE INTO users (username, password_hash, email) VALUES ";
+        for (int i = start; i < std::min(opt.users, start + SEED_BATCH); i++) {
+            auto name = benchUsername(i);
+            sql += (i == start ? "('" : ",('") + name + "','" + hash + "','" + name + "@example.com')";
+        }
+        db->execSqlSync(sql);
+    }
+
+    auto userRange = db->execSqlSync(
+        "SELECT MIN(id) AS min_id, MAX(id) AS max_id FROM users WHERE username LIKE 'bench\\_user\\_%'");
+    int minUser = userRange[0]["min_id"].as<int>();
+    int maxUser = userRange[0]["max_id"].as<int>();
+    std::uniform_int_distribution<int> userDist(minUser, maxUser);
+
+    int64_t existing = db->execSqlSync("SELECT COUNT(*) AS total FROM posts")[0]["total"].as<int64_t>();
+    if (existing >= targetPosts) {
+        std::cerr << "已有 " << existing << " 个帖子，跳过灌数据" << std::endl;
+        return;
+    }
+
+    // 帖子（创建时间分散在最近一年内）
+    std::uniform_int_distribution<int> ageDist(0, 365 * 24 * 3600);
+    for (int64_t n = existing; n < targetPosts; n += SEED_BATCH) {
+        std::string sql = "INSERT INTO posts (user_id, title, content, created_at) VALUES ";
+        int64_t end = std::min(targetPosts, n + SEED_BATCH);
+        for (int64_t i = n; i < end; i++) {
+            sql += i == n ? "(" : ",(";
+            sql += std::to_string(userDist(rng)) + ",'bench post " + std::to_string(i) +
+                   "','synthetic content for load testing, post " + std::to_string(i) +
+                   "',NOW() - INTERVAL " + std::to_string(ageDist(rng)) + " SECOND)";
+        }
+        db->execSqlSync(sql);
+        if ((n / SEED_BATCH) % 100 == 0) {
+            std::cerr << "灌入帖子 " << end << "/" << targetPosts << std::endl;
+        }
+    }
+
+    auto postRange = db->execSqlSync("SELECT MIN(id) AS min_id, MAX(id) AS max_id FROM posts");
+    std::uniform_int_distribution<int> postDist(postRange[0]["min_id"].as<int>(),
+                                                postRange[0]["max_id"].as<int>());
+
+    // 回复和点赞
+    for (int64_t n = existing; n < targetPosts; n += SEED_BATCH) {
+        std::string replies = "INSERT INTO replies (post_id, user_id, content) VALUES ";
+        std::string likes = "INSERT IGNORE INTO post_likes (post_id, user_id) VALUES ";
+        int64_t end = std::min(targetPosts, n + SEED_BATCH);
+        for (int64_t i = n; i < end; i++) {
+            replies += i == n ? "(" : ",(";
+            replies += std::to_string(postDist(rng)) + "," + std::to_string(userDist(rng)) +
+                       ",'synthetic reply " + std::to_string(i) + "')";
+            likes += i == n ? "(" : ",(";
+            likes += std::to_string(postDist(rng)) + "," + std::to_string(userDist(rng)) + ")";
+        }
+        db->execSqlSync(replies);
+        db->execSqlSync(likes);
+    }
+
+    std::cerr << "重新计算回复数和点赞数..." << std::endl;
+    db->execSqlSync(R"(
+        UPDATE posts p SET
+            reply_count = (SELECT COUNT(*) FROM replies r WHERE r.post_id = p.id),
+            like_count = (SELECT COUNT(*) FROM post_likes l WHERE l.post_id = p.id)
+    )");
+    std::cerr << "灌数据完成: " << targetPosts << " 个帖子" << std::endl;
+}
+
+// ============================================
+// 压测
+// ============================================
+
+struct RouteStats {
+    LatencyHistogram latency;
+    std::atomic<int64_t> requests{0};
+    std::atomic<int64_t> errors{0};
+};
+
+/**
+ * 压测期间共享的状态
+ */
+struct BenchState {
+    std::string url;
+    Clock::time_point deadline;
+    std::array<RouteStats, ROUTE_COUNT> stats;
+    int maxPostId = 1;
+    int totalPosts = 1;
+    std::atomic<int> active{0};
+    std::promise<void> finished;
+};
+
+/**
+ * 单个并发客户端：独占一个连接，收到响应后立即发送下一个请求
+ */
+struct Worker {
+    int index;
+    HttpClientPtr client;
+    std::string username;
+    std::string token;
+    std::mt19937 rng;
+    std::discrete_distribution<int> routeDist;
+    int64_t registered = 0;
+};
+
+/**
+ * 同步发送请求（用于压测开始前的准备）
+ */
+HttpResponsePtr sendSync(const HttpClientPtr& client, const HttpRequestPtr& req) {
+    std::promise<HttpResponsePtr> promise;
+    auto future = promise.get_future();
+    client->sendRequest(req, [&promise](ReqResult result, const HttpResponsePtr& resp) {
+        promise.set_value(result == ReqResult::Ok ? resp : nullptr);
+    });
+    return future.get();
+}
+
+HttpRequestPtr jsonRequest(HttpMethod method, const std::string& path, const Json::Value& body,
+                           const std::string& token = "") {
+    auto req = HttpRequest::newHttpJsonRequest(body);
+    req->setMethod(method);
+    req->setPath(path);
+    if (!token.empty()) {
+        req->addHeader("Authorization", "Bearer " + token);
+    }
+    return req;
+}
+
+HttpRequestPtr loginRequest(const std::string& username) {
+    Json::Value body;
+    body["username"] = username;
+    body["password"] = BENCH_PASSWORD;
+    return jsonRequest(Post, "/api/user/login", body);
+}
+
+bool isSuccess(const HttpResponsePtr& resp) {
+    return resp && resp->getJsonObject() && (*resp->getJsonObject())["code"].asInt() == 0;
+}
+
+/**
+ * 按流量比例构造下一个请求
+ */
+HttpRequestPtr buildRequest(Worker& worker, Route route, const BenchState& state) {
+    std::uniform_int_distribution<int> postDist(1, std::max(1, state.maxPostId));
+
+    switch (route) {
+        case REGISTER: {
+            Json::Value body;
+            auto name = "bench_reg_" + std::to_string(getpid()) + "_" +
+                        std::to_string(worker.index) + "_" + std::to_string(worker.registered++);
+            body["username"] = name;
+            body["password"] = BENCH_PASSWORD;
+            body["email"] = name + "@example.com";
+            return jsonRequest(Post, "/api/user/register", body);
+        }
+        case LOGIN:
+            return loginRequest(worker.username);
+        case LIST: {
+            // 偏向前几页（更接近真实访问分布）
+            int pages = std::max(1, state.totalPosts / 20);
+            std::geometric_distribution<int> pageDist(0.2);
+            auto req = HttpRequest::newHttpRequest();
+            req->setMethod(Get);
+            req->setPath("/api/post/list");
+            req->setParameter("page", std::to_string(std::min(pages, 1 + pageDist(worker.rng))));
+            req->setParameter("size", "20");
+            return req;
+        }
+        case DETAIL: {
+            auto req = HttpRequest::newHttpRequest();
+            req->setMethod(Get);
+            req->setPath("/api/post/detail");
+            req->setParameter("id", std::to_string(postDist(worker.rng)));
+            return req;
+        }
+        case CREATE: {
+            Json::Value body;
+            body["title"] = "bench post from " + worker.username;
+            body["content"] = "load test content";
+            return jsonRequest(Post, "/api/post/create", body, worker.token);
+        }
+        case REPLY: {
+            Json::Value body;
+            body["post_id"] = postDist(worker.rng);
+            body["content"] = "bench reply from " + worker.username;
+            return jsonRequest(Post, "/api/reply/create", body, worker.token);
+        }
+        case LIKE:
+        default: {
+            Json::Value body;
+            body["post_id"] = postDist(worker.rng);
+            return jsonRequest(Post, "/api/like/toggle", body, worker.token);
+        }
+    }
+}
+
+void runNext(const std::shared_ptr<Worker>& worker, const std::shared_ptr<BenchState>& state) {
+    if (Clock::now() >= state->deadline) {
+        if (--state->active == 0) {
+            state->finished.set_value();
+        }
+        return;
+    }
+
+    auto route = static_cast<Route>(worker->routeDist(worker->rng));
+    auto req = buildRequest(*worker, route, *state);
+    auto start = Clock::now();
+
+    worker->client->sendRequest(req, [worker, state, route, start](ReqResult result, const HttpResponsePtr& resp) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        auto& stats = state->stats[route];
+        stats.requests++;
+        stats.latency.record(micros);
+
+        // 帖子可能已被删除，详情返回"帖子不存在"不算错误
+        bool ok = result == ReqResult::Ok && resp &&
+                  (isSuccess(resp) || (route == DETAIL && resp->getJsonObject()));
+        if (!ok) {
+            stats.errors++;
+        } else if (route == LOGIN) {
+            worker->token = (*resp->getJsonObject())["data"]["token"].asString();
+        }
+
+        runNext(worker, state);
+    });
+}
+
+Json::Value routeReport(const char* name, const LatencyHistogram::Snapshot& snap,
+                        int64_t requests, int64_t errors, double elapsed) {
+    Json::Value r;
+    r["route"] = name;
+    r["requests"] = static_cast<Json::Int64>(requests);
+    r["errors"] = static_cast<Json::Int64>(errors);
+    r["throughput"] = requests / elapsed;
+    r["p50_ms"] = snap.percentile(0.5) / 1000.0;
+    r["p99_ms"] = snap.percentile(0.99) / 1000.0;
+    r["p999_ms"] = snap.percentile(0.999) / 1000.0;
+    r["mean_ms"] = snap.total > 0 ? snap.sumMicros / 1000.0 / snap.total : 0.0;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt;
+    std::array<double, ROUTE_COUNT> weights;
+    int64_t seedPosts;
+    try {
+        opt = parseOptions(argc, argv);
+        weights = parseMix(opt.mix);
+        seedPosts = seedPostCount(opt.seed);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (seedPosts > 0) {
+        try {
+            seedDatabase(opt, seedPosts);
+        } catch (const orm::DrogonDbException& e) {
+            std::cerr << "灌数据失败: " << e.base().what() << std::endl;
+            return 1;
+        }
+    }
+
+    // 客户端事件循环
+    std::vector<std::unique_ptr<trantor::EventLoopThread>> loopThreads;
+    for (int i = 0; i < opt.threads; i++) {
+        loopThreads.push_back(std::make_unique<trantor::EventLoopThread>("bench-" + std::to_string(i)));
+        loopThreads.back()->run();
+    }
+
+    auto state = std::make_shared<BenchState>();
+    state->url = opt.url;
+
+    // 取帖子总数和最新帖子ID，详情/回复/点赞在 [1, maxPostId] 中随机选择帖子
+    {
+        auto client = HttpClient::newHttpClient(opt.url, loopThreads[0]->getLoop());
+        auto req = HttpRequest::newHttpRequest();
+        req->setMethod(Get);
+        req->setPath("/api/post/list");
+        req->setParameter("page", "1");
+        req->setParameter("size", "1");
+        auto resp = sendSync(client, req);
+        if (!isSuccess(resp)) {
+            std::cerr << "无法访问服务: " << opt.url << std::endl;
+            return 1;
+        }
+        const auto& data = (*resp->getJsonObject())["data"];
+        state->totalPosts = std::max(1, data["total"].asInt());
+        if (!data["posts"].empty()) {
+            state->maxPostId = data["posts"][0]["id"].asInt();
+        }
+    }
+
+    // 每个客户端登录一个压测用户
+    std::vector<std::shared_ptr<Worker>> workers;
+    for (int i = 0; i < opt.concurrency; i++) {
+        auto worker = std::make_shared<Worker>();
+        worker->index = i;
+        worker->client = HttpClient::newHttpClient(opt.url, loopThreads[i % opt.threads]->getLoop());
+        worker->username = benchUsername(i % opt.users);
+        worker->rng.seed(static_cast<unsigned>(i) * 7919u + 1);
+        worker->routeDist = std::discrete_distribution<int>(weights.begin(), weights.end());
+
+        auto resp = sendSync(worker->client, loginRequest(worker->username));
+        if (!isSuccess(resp)) {
+            std::cerr << "压测用户登录失败: " << worker->username
+                      << "（请先使用 --seed 创建压测用户）" << std::endl;
+            return 1;
+        }
+        worker->token = (*resp->getJsonObject())["data"]["token"].asString();
+        workers.push_back(worker);
+    }
+
+    auto start = Clock::now();
+    state->deadline = start + std::chrono::seconds(opt.seconds);
+    state->active = opt.concurrency;
+    auto finished = state->finished.get_future();
+
+    for (int i = 0; i < opt.concurrency; i++) {
+        auto worker = workers[i];
+        loopThreads[i % opt.threads]->getLoop()->queueInLoop([worker, state]() {
+            runNext(worker, state);
+        });
+    }
+    finished.wait();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Json::Value report;
+    report["benchmark"] = "api_load";
+    report["url"] = opt.url;
+    report["seed"] = opt.seed;
+    report["total_posts"] = state->totalPosts;
+    report["concurrency"] = opt.concurrency;
+    report["seconds"] = elapsed;
+    report["mix"] = opt.mix;
+
+    LatencyHistogram::Snapshot overall;
+    int64_t totalRequests = 0;
+    int64_t totalErrors = 0;
+    Json::Value routes(Json::arrayValue);
+    for (int route = 0; route < ROUTE_COUNT; route++) {
+        const auto& stats = state->stats[route];
+        if (stats.requests == 0) {
+            continue;
+        }
+        auto snap = stats.latency.snapshot();
+        overall.merge(snap);
+        totalRequests += stats.requests;
+        totalErrors += stats.errors;
+        routes.append(routeReport(ROUTE_NAMES[route], snap, stats.requests, stats.errors, elapsed));
+    }
+    report["routes"] = routes;
+    report["total"] = routeReport("total", overall, totalRequests, totalErrors, elapsed);
+
+    Json::StreamWriterBuilder builder;
+    auto text = Json::writeString(builder, report);
+    std::cout << text << std::endl;
+
+    if (!opt.output.empty()) {
+        std::ofstream out(opt.output);
+        out << text << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * 热门帖子回复写入基准测试
+ *
+ * 模拟考试周热门帖子下集中回复的场景：多个并发客户端持续向同一个帖子发布回复，
+ * 统计每秒成功写入的回复数
+ *
+ * 对比合并写入前后：
+ *   1. config.json 中设置 custom_config.reply_coalescer.enabled = false，启动服务后运行本程序，
+ *      把输出保存为 before.json
+ *   2. 改为 true 后重启服务（MySQL 需 innodb_autoinc_lock_mode=1，否则服务启动时会关闭合并），
+ *      再次运行并把 before.json 作为最后一个参数传入，报告中给出前后对比
+ *
+ * 使用:
+ *   ./bench/reply_hot_post_bench [url] [post_id] [concurrency] [seconds] [username] [password] [baseline.json]
+ *   ./bench/reply_hot_post_bench http://127.0.0.1:8080 1 64 10 zhangsan 123456 > before.json
+ *   ./bench/reply_hot_post_bench http://127.0.0.1:8080 1 64 10 zhangsan 123456 before.json
+ */
+
+#include <drogon/drogon.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace drogon;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * 登录获取Token
+ */
+std::string login(const HttpClientPtr& client, const std::string& username, const std::string& password) {
+    Json::Value body;
+    body["username"] = username;
+    body["password"] = password;
+
+    auto req = HttpRequest::newHttpJsonRequest(body);
+    req->setMethod(Post);
+    req->setPath("/api/user/login");
+
+    std::promise<std::string> promise;
+    auto future = promise.get_future();
+    client->sendRequest(req, [&promise](ReqResult result, const HttpResponsePtr& resp) {
+        if (result != ReqResult::Ok || !resp->getJsonObject()) {
+            promise.set_value("");
+            return;
+        }
+        promise.set_value((*resp->getJsonObject())["data"]["token"].asString());
+    });
+    return future.get();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+    int post_id = argc > 2 ? std::stoi(argv[2]) : 1;
+    int concurrency = argc > 3 ? std::stoi(argv[3]) : 64;
+    int seconds = argc > 4 ? std::stoi(argv[4]) : 10;
+    std::string username = argc > 5 ? argv[5] : "zhangsan";
+    std::string password = argc > 6 ? argv[6] : "123456";
+    std::string baselineFile = argc > 7 ? argv[7] : "";
+
+    trantor::EventLoopThread loopThread;
+    loopThread.run();
+    auto loop = loopThread.getLoop();
+
+    std::string token = login(HttpClient::newHttpClient(url, loop), username, password);
+    if (token.empty()) {
+        std::cerr << "登录失败，请检查服务地址和账号: " << url << " " << username << std::endl;
+        return 1;
+    }
+
+    std::atomic<int64_t> succeeded{0};
+    std::atomic<int64_t> failed{0};
+    std::atomic<int> active{concurrency};
+    std::promise<void> finished;
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+
+    // 每个并发客户端独占一个连接，收到响应后立即发送下一条回复
+    std::vector<std::shared_ptr<std::function<void()>>> workers;
+    for (int i = 0; i < concurrency; i++) {
+        auto client = HttpClient::newHttpClient(url, loop);
+        auto worker = std::make_shared<std::function<void()>>();
+        std::weak_ptr<std::function<void()>> weakWorker = worker;
+
+        *worker = [&, client, weakWorker, i]() {
+            if (Clock::now() >= deadline) {
+                if (--active == 0) {
+                    finished.set_value();
+                }
+                return;
+            }
+
+            Json::Value body;
+            body["post_id"] = post_id;
+            body["content"] = "bench reply from client " + std::to_string(i);
+
+            auto req = HttpRequest::newHttpJsonRequest(body);
+            req->setMethod(Post);
+            req->setPath("/api/reply/create");
+            req->addHeader("Authorization", "Bearer " + token);
+
+            client->sendRequest(req, [&, weakWorker](ReqResult result, const HttpResponsePtr& resp) {
+                bool ok = result == ReqResult::Ok && resp->getJsonObject() &&
+                          (*resp->getJsonObject())["code"].asInt() == 0;
+                if (ok) {
+                    succeeded++;
+                } else {
+                    failed++;
+                }
+
+                if (auto w = weakWorker.lock()) {
+                    (*w)();
+                }
+            });
+        };
+        workers.push_back(worker);
+    }
+
+    for (auto& worker : workers) {
+        loop->queueInLoop([worker]() { (*worker)(); });
+    }
+    finished.get_future().wait();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Json::Value report;
+    report["benchmark"] = "reply_hot_post";
+    report["post_id"] = post_id;
+    report["concurrency"] = concurrency;
+    report["seconds"] = elapsed;
+    report["succeeded"] = static_cast<Json::Int64>(succeeded.load());
+    report["failed"] = static_cast<Json::Int64>(failed.load());
+    report["replies_per_second"] = succeeded.load() / elapsed;
+
+    // 与之前保存的报告对比（如关闭合并时的结果）
+    if (!baselineFile.empty()) {
+        Json::Value baseline;
+        std::ifstream in(baselineFile);
+        Json::CharReaderBuilder reader;
+        std::string errors;
+        if (!in || !Json::parseFromStream(reader, in, &baseline, &errors)) {
+            std::cerr << "无法读取对比报告: " << baselineFile << std::endl;
+            return 1;
+        }
+        double before = baseline["replies_per_second"].asDouble();
+        report["baseline_replies_per_second"] = before;
+        report["speedup"] = before > 0 ? report["replies_per_second"].asDouble() / before : 0.0;
+    }
+
+    Json::StreamWriterBuilder builder;
+    std::cout << Json::writeString(builder, report) << std::endl;
+
+    return 0;
+}
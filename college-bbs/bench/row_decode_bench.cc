@@ -0,0 +1,119 @@
+/**
+ * 查询结果逐行解码基准测试
+ *
+ * 对比回复列表按列名读取（row["content"]）和按列位置读取（models::ReplyRow::decode）
+ * 每行的解码耗时。只查询一次，之后对同一个结果反复解码，不含网络和数据库耗时
+ *
+ * 需要一个回复很多的帖子，可以先用 api_load_bench --seed 灌数据
+ *
+ * 使用:
+ *   ./bench/row_decode_bench [host] [port] [dbname] [user] [password] [post_id] [iterations]
+ *   ./bench/row_decode_bench 127.0.0.1 3306 college_bbs root 123456 0 200
+ *   post_id 为 0 时使用回复最多的帖子
+ */
+
+#include "../models/ReplyRows.h"
+#include <drogon/drogon.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace drogon;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// 与 reply.list_by_post 相同
+const char* const REPLY_LIST_SQL = R"(
+    SELECT
+        r.id,
+        r.content,
+        r.created_at,
+        r.user_id as author_id
+    FROM replies r
+    WHERE r.post_id = ?
+    ORDER BY r.created_at ASC
+)";
+
+// 防止解码被优化掉
+volatile int64_t sink;
+
+/**
+ * 对结果解码 iterations 遍，返回每行平均耗时（纳秒）
+ */
+template <typename Decode>
+double measure(const orm::Result& r, int iterations, Decode&& decode) {
+    int64_t checksum = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const auto& row : r) {
+            models::ReplyRow reply = decode(row);
+            checksum += reply.id + static_cast<int64_t>(reply.content.size());
+        }
+    }
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    sink = checksum;
+    return static_cast<double>(nanos) / (static_cast<double>(r.size()) * iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    std::string port = argc > 2 ? argv[2] : "3306";
+    std::string dbname = argc > 3 ? argv[3] : "college_bbs";
+    std::string user = argc > 4 ? argv[4] : "root";
+    std::string password = argc > 5 ? argv[5] : "123456";
+    int post_id = argc > 6 ? std::stoi(argv[6]) : 0;
+    int iterations = argc > 7 ? std::stoi(argv[7]) : 200;
+
+    auto db = orm::DbClient::newMysqlClient("host=" + host + " port=" + port + " dbname=" + dbname +
+                                            " user=" + user + " password=" + password, 1);
+
+    if (post_id == 0) {
+        auto top = db->execSqlSync(
+            "SELECT post_id FROM replies GROUP BY post_id ORDER BY COUNT(*) DESC LIMIT 1");
+        if (top.empty()) {
+            std::cerr << "没有回复数据（请先使用 api_load_bench --seed 灌数据）" << std::endl;
+            return 1;
+        }
+        post_id = top[0]["post_id"].as<int>();
+    }
+
+    auto r = db->execSqlSync(REPLY_LIST_SQL, post_id);
+    if (r.empty()) {
+        std::cerr << "帖子 " << post_id << " 没有回复" << std::endl;
+        return 1;
+    }
+    if (!sql::columnsMatch<models::ReplyRow>(r)) {
+        std::cerr << "查询的列与 models::ReplyRow 不一致" << std::endl;
+        return 1;
+    }
+
+    std::cout << "帖子 " << post_id << "，" << r.size() << " 条回复，解码 " << iterations << " 遍" << std::endl;
+
+    auto byName = [](const orm::Row& row) {
+        return models::ReplyRow{
+            row["id"].as<int>(),
+            row["content"].as<std::string>(),
+            row["created_at"].as<std::string>(),
+            row["author_id"].as<int>(),
+            std::string(),
+        };
+    };
+    auto byPosition = [](const orm::Row& row) {
+        return models::ReplyRow::decode(row);
+    };
+
+    // 先各跑一遍预热
+    measure(r, 1, byName);
+    measure(r, 1, byPosition);
+
+    double nameNanos = measure(r, iterations, byName);
+    double positionNanos = measure(r, iterations, byPosition);
+
+    std::cout << "按列名读取: " << nameNanos << " ns/行" << std::endl;
+    std::cout << "按列位置读取: " << positionNanos << " ns/行" << std::endl;
+    std::cout << "节省: " << (nameNanos - positionNanos) / nameNanos * 100 << "%" << std::endl;
+    return 0;
+}
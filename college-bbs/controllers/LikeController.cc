@@ -1,10 +1,129 @@
 #include "LikeController.h"
 #include "../utils/ResponseUtil.h"
+#include "../utils/ErrorLogger.h"
+#include "../utils/SqlStatements.h"
+#include "../utils/RequestContext.h"
+#include "../utils/LikedPostCache.h"
+#include "../utils/PostSummaryStore.h"
+#include "../utils/ParamUtil.h"
+#include "../utils/HandlerState.h"
 #include <drogon/orm/DbClient.h>
+#include <algorithm>
 
 using namespace api::v1;
 using namespace drogon::orm;
 
+namespace {
+
+// 点赞/取消点赞的请求参数
+struct ToggleLikeData {
+    int user_id;
+    int post_id;
+};
+
+using ToggleLikeStatePtr = HandlerStatePtr<ToggleLikeData>;
+
+// 查询当前点赞数并返回给用户（用于事务已回滚的场景）
+void respondLikeCount(const ToggleLikeStatePtr& state, bool liked) {
+    auto dbClient = drogon::app().getDbClient();
+    sql::execAsync(
+        state->ctx, dbClient, sql::POST_LIKE_COUNT,
+        [state, liked](const Result& r) {
+            int like_count = r[0]["like_count"].as<int>();
+            PostSummaryStore::setLikeCount(state->data.post_id, like_count);
+            Json::Value data;
+            data["liked"] = liked;
+            data["like_count"] = like_count;
+            state->respond(ResponseUtil::success(data));
+        },
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "query like count", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+        },
+        state->data.post_id
+    );
+}
+
+// 回滚事务并返回数据库错误
+void failToggle(const ToggleLikeStatePtr& state, const std::shared_ptr<Transaction>& transPtr,
+                const char* operation, const DrogonDbException& e) {
+    auto errorId = ErrorLogger::generateErrorId();
+    ErrorLogger::logDatabaseError(errorId, operation, e);
+    transPtr->rollback();
+    state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+}
+
+// 点赞记录已写入/删除：更新帖子点赞数，查询最新点赞数后提交事务
+void finishToggle(const ToggleLikeStatePtr& state, const std::shared_ptr<Transaction>& transPtr, bool like) {
+    sql::execAsync(
+        state->ctx, transPtr, like ? sql::POST_INCREMENT_LIKE : sql::POST_DECREMENT_LIKE,
+        [state, transPtr, like](const Result& r) {
+            // 查询最新的点赞数
+            sql::execAsync(
+                state->ctx, transPtr, sql::POST_LIKE_COUNT,
+                [state, transPtr, like](const Result& r) {
+                    int like_count = r[0]["like_count"].as<int>();
+
+                    // 提交事务
+                    transPtr->commit([state, like, like_count]() {
+                        LikedPostCache::update(state->data.user_id, state->data.post_id, like);
+                        PostSummaryStore::setLikeCount(state->data.post_id, like_count);
+
+                        Json::Value data;
+                        data["liked"] = like;
+                        data["like_count"] = like_count;
+
+                        state->respond(ResponseUtil::success(data));
+                    });
+                },
+                [state, transPtr](const DrogonDbException& e) {
+                    failToggle(state, transPtr, "query like count", e);
+                },
+                state->data.post_id
+            );
+        },
+        [state, transPtr](const DrogonDbException& e) {
+            failToggle(state, transPtr, "update like count", e);
+        },
+        state->data.post_id
+    );
+}
+
+// 在事务内点赞（like=true，INSERT IGNORE避免并发时UNIQUE约束冲突）或取消点赞
+// 点赞集合缓存可能已过期（其他进程改过，或本进程的缓存被淘汰后未重新加载），
+// 影响0行说明数据库中的实际状态与缓存相反：用户这次点击的意图是切换，
+// 于是更正缓存并在同一事务内执行相反的操作（flip=true时只切换一次）
+void applyToggle(const ToggleLikeStatePtr& state, const std::shared_ptr<Transaction>& transPtr,
+                 bool like, bool flip) {
+    sql::execAsync(
+        state->ctx, transPtr, like ? sql::LIKE_INSERT : sql::LIKE_DELETE,
+        [state, transPtr, like, flip](const Result& r) {
+            if (r.affectedRows() > 0) {
+                finishToggle(state, transPtr, like);
+                return;
+            }
+
+            // 数据库中已经是 like 的状态
+            LikedPostCache::update(state->data.user_id, state->data.post_id, like);
+            if (flip) {
+                applyToggle(state, transPtr, !like, false);
+                return;
+            }
+
+            // 切换后仍影响0行：并发请求刚改过（如重复点击），返回当前状态
+            transPtr->rollback();
+            respondLikeCount(state, like);
+        },
+        [state, transPtr, like](const DrogonDbException& e) {
+            failToggle(state, transPtr, like ? "insert like" : "delete like", e);
+        },
+        state->data.post_id, state->data.user_id
+    );
+}
+
+} // namespace
+
 void LikeController::toggle(const HttpRequestPtr& req,
                             std::function<void(const HttpResponsePtr&)>&& callback) {
     // 从request attributes中获取用户ID
@@ -24,183 +143,92 @@ void LikeController::toggle(const HttpRequestPtr& req,
         return;
     }
 
+    // callback、请求上下文和参数移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  ToggleLikeData{user_id, post_id});
+
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
     // 先检查帖子是否存在
-    auto sql_check_post = "SELECT id FROM posts WHERE id = ? LIMIT 1";
-
-    dbClient->execSqlAsync(
-        sql_check_post,
-        [callback, user_id, post_id, dbClient](const Result& r) {
+    sql::execAsync(
+        state->ctx, dbClient, sql::POST_EXISTS,
+        [state, dbClient](const Result& r) {
             if (r.size() == 0) {
-                callback(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+                state->respond(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
                 return;
             }
 
-            // 检查用户是否已经点赞
-            auto sql_check_like = "SELECT id FROM post_likes WHERE post_id = ? AND user_id = ? LIMIT 1";
-
-            dbClient->execSqlAsync(
-                sql_check_like,
-                [callback, user_id, post_id, dbClient](const Result& r) {
-                    bool already_liked = (r.size() > 0);
-
+            // 检查用户是否已经点赞（优先查内存中的点赞集合）
+            LikedPostCache::isLiked(
+                state->ctx, state->data.user_id, state->data.post_id,
+                [state, dbClient](bool already_liked) {
                     // 使用事务保证数据一致性
-                    auto transPtr = dbClient->newTransaction();
-
-                    if (already_liked) {
-                        // 已经点赞，执行取消点赞操作
-                        auto sql_delete = "DELETE FROM post_likes WHERE post_id = ? AND user_id = ?";
-
-                        transPtr->execSqlAsync(
-                            sql_delete,
-                            [callback, post_id, transPtr](const Result& r) {
-                                // 检查是否删除成功
-                                if (r.affectedRows() == 0) {
-                                    transPtr->rollback();
-                                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "取消点赞失败"));
-                                    return;
-                                }
-
-                                // 更新帖子的点赞数 -1
-                                auto sql_update = "UPDATE posts SET like_count = like_count - 1 WHERE id = ? AND like_count > 0";
-
-                                transPtr->execSqlAsync(
-                                    sql_update,
-                                    [callback, post_id, transPtr](const Result& r) {
-                                        // 查询最新的点赞数
-                                        auto sql_count = "SELECT like_count FROM posts WHERE id = ?";
-
-                                        transPtr->execSqlAsync(
-                                            sql_count,
-                                            [callback, transPtr](const Result& r) {
-                                                int like_count = r[0]["like_count"].as<int>();
-
-                                                // 提交事务
-                                                transPtr->commit([callback, like_count]() {
-                                                    Json::Value data;
-                                                    data["liked"] = false;
-                                                    data["like_count"] = like_count;
-
-                                                    callback(ResponseUtil::success(data));
-                                                });
-                                            },
-                                            [callback, transPtr](const DrogonDbException& e) {
-                                                LOG_ERROR << "Query like count error: " << e.base().what();
-                                                transPtr->rollback();
-                                                callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                                            },
-                                            post_id
-                                        );
-                                    },
-                                    [callback, transPtr](const DrogonDbException& e) {
-                                        LOG_ERROR << "Update like count error: " << e.base().what();
-                                        transPtr->rollback();
-                                        callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                                    },
-                                    post_id
-                                );
-                            },
-                            [callback, transPtr](const DrogonDbException& e) {
-                                LOG_ERROR << "Delete like error: " << e.base().what();
-                                transPtr->rollback();
-                                callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                            },
-                            post_id, user_id
-                        );
-                    } else {
-                        // 未点赞，执行点赞操作
-                        // 使用INSERT IGNORE避免并发时UNIQUE约束冲突
-                        auto sql_insert = "INSERT IGNORE INTO post_likes (post_id, user_id) VALUES (?, ?)";
-
-                        transPtr->execSqlAsync(
-                            sql_insert,
-                            [callback, post_id, transPtr](const Result& r) {
-                                // 检查是否真正插入了数据
-                                if (r.affectedRows() == 0) {
-                                    // 数据已存在（并发情况），直接返回成功
-                                    transPtr->rollback();
-
-                                    // 查询当前点赞数返回给用户
-                                    auto dbClient = drogon::app().getDbClient();
-                                    auto sql_count = "SELECT like_count FROM posts WHERE id = ?";
-                                    dbClient->execSqlAsync(
-                                        sql_count,
-                                        [callback](const Result& r) {
-                                            int like_count = r[0]["like_count"].as<int>();
-                                            Json::Value data;
-                                            data["liked"] = true;
-                                            data["like_count"] = like_count;
-                                            callback(ResponseUtil::success(data));
-                                        },
-                                        [callback](const DrogonDbException& e) {
-                                            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                                        },
-                                        post_id
-                                    );
-                                    return;
-                                }
-
-                                // 成功插入，更新帖子的点赞数 +1
-                                auto sql_update = "UPDATE posts SET like_count = like_count + 1 WHERE id = ?";
-
-                                transPtr->execSqlAsync(
-                                    sql_update,
-                                    [callback, post_id, transPtr](const Result& r) {
-                                        // 查询最新的点赞数
-                                        auto sql_count = "SELECT like_count FROM posts WHERE id = ?";
-
-                                        transPtr->execSqlAsync(
-                                            sql_count,
-                                            [callback, transPtr](const Result& r) {
-                                                int like_count = r[0]["like_count"].as<int>();
-
-                                                // 提交事务
-                                                transPtr->commit([callback, like_count]() {
-                                                    Json::Value data;
-                                                    data["liked"] = true;
-                                                    data["like_count"] = like_count;
-
-                                                    callback(ResponseUtil::success(data));
-                                                });
-                                            },
-                                            [callback, transPtr](const DrogonDbException& e) {
-                                                LOG_ERROR << "Query like count error: " << e.base().what();
-                                                transPtr->rollback();
-                                                callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                                            },
-                                            post_id
-                                        );
-                                    },
-                                    [callback, transPtr](const DrogonDbException& e) {
-                                        LOG_ERROR << "Update like count error: " << e.base().what();
-                                        transPtr->rollback();
-                                        callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                                    },
-                                    post_id
-                                );
-                            },
-                            [callback, transPtr](const DrogonDbException& e) {
-                                LOG_ERROR << "Insert like error: " << e.base().what();
-                                transPtr->rollback();
-                                callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                            },
-                            post_id, user_id
-                        );
-                    }
+                    // 已点赞则取消点赞，否则点赞
+                    applyToggle(state, dbClient->newTransaction(), !already_liked, true);
                 },
-                [callback](const DrogonDbException& e) {
-                    LOG_ERROR << "Check like error: " << e.base().what();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                },
-                post_id, user_id
+                [state](const DrogonDbException& e) {
+                    auto errorId = ErrorLogger::generateErrorId();
+                    ErrorLogger::logDatabaseError(errorId, "load liked posts", e);
+                    state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+                }
             );
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Check post error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "check post exists", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+        },
+        state->data.post_id
+    );
+}
+
+void LikeController::getStatus(const HttpRequestPtr& req,
+                               std::function<void(const HttpResponsePtr&)>&& callback) {
+    // 从request attributes中获取用户ID
+    auto user_id = req->attributes()->get<int>("user_id");
+
+    // 解析帖子ID列表，格式: post_ids=1,2,3
+    const auto& raw = req->getParameter("post_ids");
+    if (raw.empty()) {
+        callback(ResponseUtil::error(ResponseUtil::PARAM_ERROR, "缺少帖子ID"));
+        return;
+    }
+
+    std::vector<int> post_ids;
+    if (!ParamUtil::parseIntList(raw, post_ids)) {
+        callback(ResponseUtil::error(ResponseUtil::PARAM_ERROR, "帖子ID格式错误"));
+        return;
+    }
+    post_ids.erase(std::remove_if(post_ids.begin(), post_ids.end(), [](int id) { return id <= 0; }),
+                   post_ids.end());
+
+    // 限制单次查询数量（与分页上限一致）
+    if (post_ids.empty() || post_ids.size() > 100) {
+        callback(ResponseUtil::error(ResponseUtil::PARAM_ERROR, "帖子ID数量必须在1-100之间"));
+        return;
+    }
+
+    // callback和请求上下文移入共享状态，两个回调只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req));
+
+    LikedPostCache::getLikedPostIds(
+        state->ctx, user_id, std::move(post_ids),
+        [state](const std::vector<int>& liked_post_ids) {
+            Json::Value ids(Json::arrayValue);
+            for (int id : liked_post_ids) {
+                ids.append(id);
+            }
+
+            Json::Value data;
+            data["liked_post_ids"] = ids;
+
+            state->respond(ResponseUtil::success(data));
         },
-        post_id
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "load liked posts", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+        }
     );
 }
@@ -16,6 +16,9 @@ public:
     METHOD_LIST_BEGIN
     // 点赞/取消点赞 POST /api/like/toggle (需要认证)
     ADD_METHOD_TO(LikeController::toggle, "/api/like/toggle", Post, "AuthFilter");
+
+    // 批量查询点赞状态 GET /api/like/status?post_ids=1,2,3 (需要认证)
+    ADD_METHOD_TO(LikeController::getStatus, "/api/like/status", Get, "AuthFilter");
     METHOD_LIST_END
 
     /**
@@ -23,6 +26,12 @@ public:
      */
     void toggle(const HttpRequestPtr& req,
                std::function<void(const HttpResponsePtr&)>&& callback);
+
+    /**
+     * 批量查询当前用户对帖子的点赞状态
+     */
+    void getStatus(const HttpRequestPtr& req,
+                  std::function<void(const HttpResponsePtr&)>&& callback);
 };
 
 } // namespace v1
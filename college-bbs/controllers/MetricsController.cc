@@ -0,0 +1,12 @@
+#include "MetricsController.h"
+#include "../utils/Metrics.h"
+
+using namespace api::v1;
+
+void MetricsController::getMetrics(const HttpRequestPtr& req,
+                                   std::function<void(const HttpResponsePtr&)>&& callback) {
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setContentTypeString("text/plain; version=0.0.4; charset=utf-8");
+    resp->setBody(Metrics::renderPrometheus());
+    callback(resp);
+}
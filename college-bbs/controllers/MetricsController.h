@@ -0,0 +1,29 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+
+using namespace drogon;
+
+namespace api {
+namespace v1 {
+
+/**
+ * 指标控制器
+ * 以Prometheus文本格式输出运行指标
+ */
+class MetricsController : public drogon::HttpController<MetricsController> {
+public:
+    METHOD_LIST_BEGIN
+    // 运行指标 GET /metrics
+    ADD_METHOD_TO(MetricsController::getMetrics, "/metrics", Get, "MetricsAccessFilter");
+    METHOD_LIST_END
+
+    /**
+     * 获取运行指标
+     */
+    void getMetrics(const HttpRequestPtr& req,
+                   std::function<void(const HttpResponsePtr&)>&& callback);
+};
+
+} // namespace v1
+} // namespace api
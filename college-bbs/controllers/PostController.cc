@@ -1,10 +1,174 @@
 #include "PostController.h"
 #include "../utils/ResponseUtil.h"
+#include "../utils/ErrorLogger.h"
+#include "../utils/SqlStatements.h"
+#include "../utils/RequestContext.h"
+#include "../utils/UserNameCache.h"
+#include "../utils/PostSummaryStore.h"
+#include "../utils/ParamUtil.h"
+#include "../utils/HandlerState.h"
+#include "../utils/PostResponseCache.h"
+#include "../utils/ViewCounter.h"
+#include "../models/PostRows.h"
+#include "../models/ReplyRows.h"
 #include <drogon/orm/DbClient.h>
+#include <memory_resource>
+#include <unordered_map>
 
 using namespace api::v1;
 using namespace drogon::orm;
 
+namespace {
+
+/**
+ * 从批量查询结果中取作者用户名（用户不存在时为空字符串）
+ */
+std::string authorName(const UserNameCache::Names& names, int author_id) {
+    auto it = names.find(author_id);
+    return it == names.end() ? std::string() : it->second;
+}
+
+// 帖子ID → 摘要JSON片段
+using Fragments = std::unordered_map<int, std::string>;
+
+/**
+ * 按顺序拼接帖子摘要数组，优先使用loaded中的片段，其次使用缓存
+ * @return 两者都没有的帖子ID
+ */
+std::pmr::vector<int> appendSummaries(const std::pmr::vector<int>& post_ids, const Fragments& loaded,
+                                      std::string& out) {
+    std::pmr::vector<int> missing(post_ids.get_allocator());
+    out += '[';
+    bool first = true;
+    for (int post_id : post_ids) {
+        size_t mark = out.size();
+        if (!first) {
+            out += ',';
+        }
+
+        auto it = loaded.find(post_id);
+        if (it != loaded.end()) {
+            out += it->second;
+        } else if (!PostSummaryStore::appendTo(post_id, out)) {
+            out.resize(mark);
+            missing.push_back(post_id);
+            continue;
+        }
+        first = false;
+    }
+    out += ']';
+    return missing;
+}
+
+/**
+ * 从数据库加载帖子摘要，填充作者用户名后渲染并缓存
+ * @param callback 参数为加载到的片段（已删除的帖子不在其中）
+ */
+void loadSummaries(const RequestContextPtr& ctx, const std::pmr::vector<int>& post_ids,
+                   std::function<void(const Fragments&)>&& callback,
+                   std::function<void(const DrogonDbException&)>&& errorCallback) {
+    auto dbClient = drogon::app().getDbClient();
+    auto onError = std::make_shared<std::function<void(const DrogonDbException&)>>(
+        std::move(errorCallback));
+
+    sql::execInAsync(
+        ctx, dbClient, sql::POST_SUMMARIES_BY_IDS, post_ids.data(), post_ids.size(),
+        [ctx, callback = std::move(callback), onError](const Result& r) {
+            auto summaries = std::make_shared<std::vector<PostSummary>>();
+            std::pmr::vector<int> author_ids(RequestContext::memoryResource(ctx));
+            sql::forEachRow<models::PostSummaryRow>(r, [&](models::PostSummaryRow&& row) {
+                PostSummary summary;
+                summary.id = row.id;
+                summary.title = std::move(row.title);
+                summary.author_id = row.author_id;
+                summary.view_count = row.view_count;
+                summary.like_count = row.like_count;
+                summary.reply_count = row.reply_count;
+                summary.created_at = std::move(row.created_at);
+
+                author_ids.push_back(summary.author_id);
+                summaries->push_back(std::move(summary));
+            });
+
+            UserNameCache::resolve(
+                ctx, author_ids,
+                [callback, summaries](const UserNameCache::Names& names) {
+                    Fragments fragments;
+                    for (auto& summary : *summaries) {
+                        summary.author = authorName(names, summary.author_id);
+                        fragments.emplace(summary.id, PostSummaryStore::put(summary));
+                    }
+                    callback(fragments);
+                },
+                [onError](const DrogonDbException& e) {
+                    (*onError)(e);
+                }
+            );
+        },
+        [onError](const DrogonDbException& e) {
+            (*onError)(e);
+        }
+    );
+}
+
+/**
+ * 用详情查询的最新数据刷新帖子摘要（含刚增加的浏览次数）
+ */
+void refreshSummary(const models::PostDetailRow& post) {
+    PostSummary summary;
+    summary.id = post.id;
+    summary.title = post.title;
+    summary.author_id = post.author_id;
+    summary.author = post.author;
+    summary.view_count = post.view_count;
+    summary.like_count = post.like_count;
+    summary.reply_count = post.reply_count;
+    summary.created_at = post.created_at;
+    PostSummaryStore::put(summary);
+}
+
+/**
+ * 帖子列表的data字段（帖子数组由已序列化的摘要片段拼接而成）
+ */
+struct PostListData {
+    int page;
+    json::Raw posts;
+    int size;
+    int total;
+
+    static constexpr auto jsonFields() {
+        return std::make_tuple(json::field("page", &PostListData::page),
+                               json::field("posts", &PostListData::posts),
+                               json::field("size", &PostListData::size),
+                               json::field("total", &PostListData::total));
+    }
+};
+
+std::string postListData(std::string posts, int total, int page, int size) {
+    return json::toJson(PostListData{page, json::Raw{std::move(posts)}, size, total});
+}
+
+/**
+ * 帖子详情的data字段
+ */
+struct PostDetailData {
+    models::PostDetailRow post;
+    std::vector<models::ReplyRow> replies;
+
+    static constexpr auto jsonFields() {
+        return std::make_tuple(json::field("post", &PostDetailData::post),
+                               json::field("replies", &PostDetailData::replies));
+    }
+};
+
+// 删除帖子的请求参数
+struct DeletePostData {
+    int user_id;
+    int post_id;
+};
+
+} // namespace
+
 void PostController::create(const HttpRequestPtr& req,
                             std::function<void(const HttpResponsePtr&)>&& callback) {
     // 从request attributes中获取用户ID
@@ -39,25 +203,28 @@ void PostController::create(const HttpRequestPtr& req,
         return;
     }
 
+    // callback和请求上下文移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req));
+
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
     // 插入帖子
-    auto sql = "INSERT INTO posts (user_id, title, content) VALUES (?, ?, ?)";
-
-    dbClient->execSqlAsync(
-        sql,
-        [callback](const Result& r) {
+    sql::execAsync(
+        state->ctx, dbClient, sql::POST_INSERT,
+        [state](const Result& r) {
             auto insert_id = r.insertId();
 
             Json::Value data;
             data["post_id"] = static_cast<int>(insert_id);
+            PostResponseCache::invalidateLists();
 
-            callback(ResponseUtil::success(data, "发帖成功"));
+            state->respond(ResponseUtil::success(data, "发帖成功"));
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Database error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "create post", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
         },
         user_id, title, content
     );
@@ -65,26 +232,11 @@ void PostController::create(const HttpRequestPtr& req,
 
 void PostController::getList(const HttpRequestPtr& req,
                              std::function<void(const HttpResponsePtr&)>&& callback) {
-    // 获取分页参数
-    auto params = req->getParameters();
+    // 获取分页参数（格式错误时使用默认值）
     int page = 1;
     int size = 20;
-
-    if (params.find("page") != params.end()) {
-        try {
-            page = std::stoi(params.at("page"));
-        } catch (...) {
-            page = 1;
-        }
-    }
-
-    if (params.find("size") != params.end()) {
-        try {
-            size = std::stoi(params.at("size"));
-        } catch (...) {
-            size = 20;
-        }
-    }
+    ParamUtil::parseInt(req->getParameter("page"), page);
+    ParamUtil::parseInt(req->getParameter("size"), size);
 
     // 限制分页参数
     if (page < 1) page = 1;
@@ -93,71 +245,67 @@ void PostController::getList(const HttpRequestPtr& req,
 
     int offset = (page - 1) * size;
 
-    // 获取数据库客户端
-    auto dbClient = drogon::app().getDbClient();
-
-    // 先查询总数
-    auto sql_count = "SELECT COUNT(*) as total FROM posts";
-
-    dbClient->execSqlAsync(
-        sql_count,
-        [callback, page, size, offset, dbClient](const Result& r) {
-            int total = r[0]["total"].as<int>();
-
-            // 查询帖子列表
-            auto sql_list = R"(
-                SELECT
-                    p.id,
-                    p.title,
-                    p.view_count,
-                    p.like_count,
-                    p.reply_count,
-                    p.created_at,
-                    u.id as author_id,
-                    u.username as author
-                FROM posts p
-                JOIN users u ON p.user_id = u.id
-                ORDER BY p.created_at DESC
-                LIMIT ? OFFSET ?
-            )";
-
-            dbClient->execSqlAsync(
-                sql_list,
-                [callback, total, page, size](const Result& r) {
-                    Json::Value posts(Json::arrayValue);
-
-                    for (const auto& row : r) {
-                        Json::Value post;
-                        post["id"] = row["id"].as<int>();
-                        post["title"] = row["title"].as<std::string>();
-                        post["author"] = row["author"].as<std::string>();
-                        post["author_id"] = row["author_id"].as<int>();
-                        post["view_count"] = row["view_count"].as<int>();
-                        post["reply_count"] = row["reply_count"].as<int>();
-                        post["like_count"] = row["like_count"].as<int>();
-                        post["created_at"] = row["created_at"].as<std::string>();
-
-                        posts.append(post);
-                    }
-
-                    Json::Value data;
-                    data["posts"] = posts;
-                    data["total"] = total;
-                    data["page"] = page;
-                    data["size"] = size;
+    // 请求上下文（按路由统计数据库耗时）
+    auto ctx = RequestContext::get(req);
+
+    // 同一页的并发请求共用一次读取，结果缓存后先返回再后台刷新
+    PostResponseCache::list(
+        page, size,
+        [ctx, page, size, offset](PostResponseCache::Done done) {
+            // 获取数据库客户端
+            auto dbClient = drogon::app().getDbClient();
+            auto onError = [done](const DrogonDbException& e) {
+                auto errorId = ErrorLogger::generateErrorId();
+                ErrorLogger::logDatabaseError(errorId, "list posts", e);
+                done(PostResponseCache::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+            };
+
+            // 先查询总数
+            sql::execAsync(
+                ctx, dbClient, sql::POST_COUNT,
+                [ctx, page, size, offset, dbClient, done, onError](const Result& r) {
+                    int total = r[0]["total"].as<int>();
+
+                    // 查询当前页的帖子ID，摘要优先使用预渲染的片段
+                    sql::execAsync(
+                        ctx, dbClient, sql::POST_LIST_IDS,
+                        [ctx, total, page, size, done, onError](const Result& r) {
+                            // 临时数组使用请求内存池
+                            std::pmr::vector<int> post_ids(RequestContext::memoryResource(ctx));
+                            post_ids.reserve(r.size());
+                            sql::forEachRow<models::PostIdRow>(r, [&post_ids](models::PostIdRow&& row) {
+                                post_ids.push_back(row.id);
+                            });
+
+                            std::string posts;
+                            posts.reserve(post_ids.size() * 256);
+                            auto missing = appendSummaries(post_ids, {}, posts);
+                            if (missing.empty()) {
+                                done(PostResponseCache::success(postListData(std::move(posts), total, page, size)));
+                                return;
+                            }
 
-                    callback(ResponseUtil::success(data));
-                },
-                [callback](const DrogonDbException& e) {
-                    LOG_ERROR << "Database error: " << e.base().what();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+                            // 未缓存的帖子从数据库加载后渲染
+                            loadSummaries(
+                                ctx, missing,
+                                [post_ids = std::move(post_ids), total, page, size, done](const Fragments& loaded) {
+                                    std::string posts;
+                                    posts.reserve(post_ids.size() * 256);
+                                    appendSummaries(post_ids, loaded, posts);
+                                    done(PostResponseCache::success(postListData(std::move(posts), total, page, size)));
+                                },
+                                onError
+                            );
+                        },
+                        onError,
+                        size, offset
+                    );
                 },
-                size, offset
+                onError
             );
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Database error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [callback = std::move(callback)](const PostResponseCache::ResultPtr& result) {
+            callback(PostResponseCache::toResponse(result));
         }
     );
 }
@@ -165,16 +313,14 @@ void PostController::getList(const HttpRequestPtr& req,
 void PostController::getDetail(const HttpRequestPtr& req,
                                std::function<void(const HttpResponsePtr&)>&& callback) {
     // 获取帖子ID
-    auto params = req->getParameters();
-    if (params.find("id") == params.end()) {
+    const auto& id_param = req->getParameter("id");
+    if (id_param.empty()) {
         callback(ResponseUtil::error(ResponseUtil::PARAM_ERROR, "缺少帖子ID"));
         return;
     }
 
     int post_id;
-    try {
-        post_id = std::stoi(params.at("id"));
-    } catch (...) {
+    if (!ParamUtil::parseInt(id_param, post_id)) {
         callback(ResponseUtil::error(ResponseUtil::PARAM_ERROR, "帖子ID格式错误"));
         return;
     }
@@ -185,108 +331,102 @@ void PostController::getDetail(const HttpRequestPtr& req,
         return;
     }
 
-    // 获取数据库客户端
-    auto dbClient = drogon::app().getDbClient();
-
-    // 先更新浏览次数，然后在回调中查询帖子信息（避免竞态条件）
-    auto sql_update = "UPDATE posts SET view_count = view_count + 1 WHERE id = ?";
-    dbClient->execSqlAsync(
-        sql_update,
-        [callback, post_id, dbClient](const Result& r) {
-            // 浏览次数更新成功，现在查询帖子信息
-            auto sql_post = R"(
-                SELECT
-                    p.id,
-                    p.title,
-                    p.content,
-                    p.view_count,
-                    p.like_count,
-                    p.reply_count,
-                    p.created_at,
-                    u.id as author_id,
-                    u.username as author
-                FROM posts p
-                JOIN users u ON p.user_id = u.id
-                WHERE p.id = ?
-                LIMIT 1
-            )";
-
-            dbClient->execSqlAsync(
-                sql_post,
-                [callback, post_id, dbClient](const Result& r) {
-                    if (r.size() == 0) {
-                        callback(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
-                        return;
-                    }
-
-                    auto row = r[0];
-
-                    Json::Value post;
-                    post["id"] = row["id"].as<int>();
-                    post["title"] = row["title"].as<std::string>();
-                    post["content"] = row["content"].as<std::string>();
-                    post["author"] = row["author"].as<std::string>();
-                    post["author_id"] = row["author_id"].as<int>();
-                    post["view_count"] = row["view_count"].as<int>(); // 已经包含了最新的浏览次数
-                    post["like_count"] = row["like_count"].as<int>();
-                    post["reply_count"] = row["reply_count"].as<int>();
-                    post["created_at"] = row["created_at"].as<std::string>();
-
-                    // 查询回复列表
-                    auto sql_replies = R"(
-                        SELECT
-                            r.id,
-                            r.content,
-                            r.created_at,
-                            u.id as author_id,
-                            u.username as author
-                        FROM replies r
-                        JOIN users u ON r.user_id = u.id
-                        WHERE r.post_id = ?
-                        ORDER BY r.created_at ASC
-                    )";
-
-                    dbClient->execSqlAsync(
-                        sql_replies,
-                        [callback, post](const Result& r) {
-                            Json::Value replies(Json::arrayValue);
-
-                            for (const auto& row : r) {
-                                Json::Value reply;
-                                reply["id"] = row["id"].as<int>();
-                                reply["content"] = row["content"].as<std::string>();
-                                reply["author"] = row["author"].as<std::string>();
-                                reply["author_id"] = row["author_id"].as<int>();
-                                reply["created_at"] = row["created_at"].as<std::string>();
-
-                                replies.append(reply);
-                            }
-
-                            Json::Value data;
-                            data["post"] = post;
-                            data["replies"] = replies;
-
-                            callback(ResponseUtil::success(data));
-                        },
-                        [callback](const DrogonDbException& e) {
-                            LOG_ERROR << "Database error: " << e.base().what();
-                            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                        },
-                        post_id
-                    );
-                },
-                [callback](const DrogonDbException& e) {
-                    LOG_ERROR << "Database error: " << e.base().what();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                },
-                post_id
-            );
-        },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Update view count error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+    // 请求上下文（按路由统计数据库耗时）
+    auto ctx = RequestContext::get(req);
+
+    // 同一帖子的并发请求共用一次读取，结果缓存后先返回再后台刷新
+    PostResponseCache::detail(
+        post_id,
+        [ctx, post_id](PostResponseCache::Done done) {
+            // 获取数据库客户端
+            auto dbClient = drogon::app().getDbClient();
+            auto onError = [done](const DrogonDbException& e) {
+                auto errorId = ErrorLogger::generateErrorId();
+                ErrorLogger::logDatabaseError(errorId, "query post detail", e);
+                done(PostResponseCache::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+            };
+
+            // 查询帖子信息和回复列表
+            auto read = [ctx, post_id, dbClient, done, onError]() {
+                sql::execAsync(
+                    ctx, dbClient, sql::POST_DETAIL,
+                    [ctx, post_id, dbClient, done, onError](const Result& r) {
+                        if (r.size() == 0) {
+                            done(PostResponseCache::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+                            return;
+                        }
+
+                        // 浏览次数已经包含了刚写回的访问
+                        auto detail = std::make_shared<PostDetailData>();
+                        detail->post = sql::firstRow<models::PostDetailRow>(r);
+
+                        // 查询回复列表
+                        sql::execAsync(
+                            ctx, dbClient, sql::REPLY_LIST_BY_POST,
+                            [ctx, detail, done, onError](const Result& r) {
+                                std::pmr::vector<int> author_ids(RequestContext::memoryResource(ctx));
+                                author_ids.reserve(r.size() + 1);
+                                author_ids.push_back(detail->post.author_id);
+
+                                detail->replies.reserve(r.size());
+                                sql::forEachRow<models::ReplyRow>(r, [&](models::ReplyRow&& row) {
+                                    author_ids.push_back(row.author_id);
+                                    detail->replies.push_back(std::move(row));
+                                });
+
+                                // 帖子和回复的作者用户名一次性从缓存填充
+                                UserNameCache::resolve(
+                                    ctx, author_ids,
+                                    [detail, done](const UserNameCache::Names& names) {
+                                        detail->post.author = authorName(names, detail->post.author_id);
+                                        refreshSummary(detail->post);
+                                        for (auto& reply : detail->replies) {
+                                            reply.author = authorName(names, reply.author_id);
+                                        }
+
+                                        // 序列化一次，所有等待的请求共用
+                                        done(PostResponseCache::success(json::toJson(*detail)));
+                                    },
+                                    onError
+                                );
+                            },
+                            onError,
+                            post_id
+                        );
+                    },
+                    onError,
+                    post_id
+                );
+            };
+
+            // 先写回累计的浏览次数，再查询帖子信息（读到的浏览次数包含这些访问）
+            ViewCounter::take(post_id, [ctx, post_id, dbClient, done, read](int views) {
+                if (views == 0) {
+                    read();
+                    return;
+                }
+                sql::execAsync(
+                    ctx, dbClient, sql::POST_ADD_VIEWS,
+                    [read](const Result& r) {
+                        read();
+                    },
+                    [post_id, views, read](const DrogonDbException& e) {
+                        ErrorLogger::logBackgroundError("flush post views", e);
+                        // 次数加回累加器，照常读取详情
+                        ViewCounter::add(post_id, views);
+                        read();
+                    },
+                    views, post_id
+                );
+            });
         },
-        post_id
+        [post_id, callback = std::move(callback)](const PostResponseCache::ResultPtr& result) {
+            // 帖子存在时才计入浏览次数（先在内存中累加）
+            if (result->code == ResponseUtil::SUCCESS) {
+                ViewCounter::add(post_id);
+            }
+            callback(PostResponseCache::toResponse(result));
+        }
     );
 }
 
@@ -309,47 +449,49 @@ void PostController::deletePost(const HttpRequestPtr& req,
         return;
     }
 
+    // callback、请求上下文和参数移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  DeletePostData{user_id, post_id});
+
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
-    // 先查询帖子是否存在，以及是否是当前用户创建的
-    auto sql_check = "SELECT user_id FROM posts WHERE id = ? LIMIT 1";
-
-    dbClient->execSqlAsync(
-        sql_check,
-        [callback, user_id, post_id, dbClient](const Result& r) {
-            if (r.size() == 0) {
-                callback(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+    // 带上 user_id 条件直接删除（标记删除，立即对所有读取不可见；回复和点赞由 PostPurger 在后台分批清除）
+    sql::execAsync(
+        state->ctx, dbClient, sql::POST_DELETE,
+        [state, dbClient](const Result& r) {
+            int post_id = state->data.post_id;
+            if (r.affectedRows() > 0) {
+                PostSummaryStore::remove(post_id);
+                PostResponseCache::invalidateLists();
+                PostResponseCache::invalidateDetail(post_id);
+                state->respond(ResponseUtil::success(Json::Value::null, "删除成功"));
                 return;
             }
 
-            int post_user_id = r[0]["user_id"].as<int>();
-
-            // 检查权限
-            if (post_user_id != user_id) {
-                callback(ResponseUtil::error(ResponseUtil::NO_PERMISSION, "无权限操作"));
-                return;
-            }
-
-            // 删除帖子（级联删除回复和点赞）
-            auto sql_delete = "DELETE FROM posts WHERE id = ?";
-
-            dbClient->execSqlAsync(
-                sql_delete,
-                [callback](const Result& r) {
-                    callback(ResponseUtil::success(Json::Value::null, "删除成功"));
+            // 没有删除任何行：再查一次区分帖子不存在和无权限
+            sql::execAsync(
+                state->ctx, dbClient, sql::POST_OWNER,
+                [state](const Result& r) {
+                    if (r.size() == 0 || r[0]["user_id"].as<int>() == state->data.user_id) {
+                        state->respond(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+                        return;
+                    }
+                    state->respond(ResponseUtil::error(ResponseUtil::NO_PERMISSION, "无权限操作"));
                 },
-                [callback](const DrogonDbException& e) {
-                    LOG_ERROR << "Database error: " << e.base().what();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+                [state](const DrogonDbException& e) {
+                    auto errorId = ErrorLogger::generateErrorId();
+                    ErrorLogger::logDatabaseError(errorId, "query post owner", e);
+                    state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
                 },
                 post_id
             );
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Database error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "delete post", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
         },
-        post_id
+        post_id, user_id
     );
 }
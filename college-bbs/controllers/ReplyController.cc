@@ -1,10 +1,35 @@
 #include "ReplyController.h"
 #include "../utils/ResponseUtil.h"
+#include "../utils/ErrorLogger.h"
+#include "../utils/SqlStatements.h"
+#include "../utils/RequestContext.h"
+#include "../utils/ReplyWriteCoalescer.h"
+#include "../utils/PostSummaryStore.h"
+#include "../utils/PostResponseCache.h"
+#include "../utils/HandlerState.h"
 #include <drogon/orm/DbClient.h>
 
 using namespace api::v1;
 using namespace drogon::orm;
 
+namespace {
+
+// 发表回复的请求参数
+struct CreateReplyData {
+    int user_id;
+    int post_id;
+    std::string content;
+};
+
+// 删除回复的请求参数（post_id 在查询回复后填入）
+struct DeleteReplyData {
+    int user_id;
+    int reply_id;
+    int post_id;
+};
+
+} // namespace
+
 void ReplyController::create(const HttpRequestPtr& req,
                              std::function<void(const HttpResponsePtr&)>&& callback) {
     // 从request attributes中获取用户ID
@@ -38,66 +63,44 @@ void ReplyController::create(const HttpRequestPtr& req,
         return;
     }
 
+    // callback、请求上下文和回复内容移入共享状态，各层闭包只持有指针（不复制内容）
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  CreateReplyData{user_id, post_id, std::move(content)});
+
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
     // 先检查帖子是否存在
-    auto sql_check = "SELECT id FROM posts WHERE id = ? LIMIT 1";
-
-    dbClient->execSqlAsync(
-        sql_check,
-        [callback, user_id, post_id, content, dbClient](const Result& r) {
+    sql::execAsync(
+        state->ctx, dbClient, sql::POST_EXISTS,
+        [state](const Result& r) {
             if (r.size() == 0) {
-                callback(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+                state->respond(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
                 return;
             }
 
-            // 使用事务保证数据一致性
-            auto transPtr = dbClient->newTransaction();
-
-            // 插入回复
-            auto sql_insert = "INSERT INTO replies (post_id, user_id, content) VALUES (?, ?, ?)";
+            // 插入回复并更新帖子回复数（高并发时按时间窗口合并写入）
+            // 内容此后不再使用，直接移交给合并器
+            auto& data = state->data;
+            ReplyWriteCoalescer::submit(
+                state->ctx, data.post_id, data.user_id, std::move(data.content),
+                [state](int64_t reply_id) {
+                    Json::Value data;
+                    data["reply_id"] = static_cast<int>(reply_id);
 
-            transPtr->execSqlAsync(
-                sql_insert,
-                [callback, post_id, transPtr](const Result& r) {
-                    auto insert_id = r.insertId();
-
-                    // 更新帖子的回复数 +1
-                    auto sql_update = "UPDATE posts SET reply_count = reply_count + 1 WHERE id = ?";
-
-                    transPtr->execSqlAsync(
-                        sql_update,
-                        [callback, insert_id, transPtr](const Result& r) {
-                            // 提交事务
-                            transPtr->commit([callback, insert_id]() {
-                                Json::Value data;
-                                data["reply_id"] = static_cast<int>(insert_id);
-
-                                callback(ResponseUtil::success(data, "回复成功"));
-                            });
-                        },
-                        [callback, transPtr](const DrogonDbException& e) {
-                            LOG_ERROR << "Update reply count error: " << e.base().what();
-                            // 回滚事务
-                            transPtr->rollback();
-                            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                        },
-                        post_id
-                    );
+                    state->respond(ResponseUtil::success(data, "回复成功"));
                 },
-                [callback, transPtr](const DrogonDbException& e) {
-                    LOG_ERROR << "Database error: " << e.base().what();
-                    // 回滚事务
-                    transPtr->rollback();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                },
-                post_id, user_id, content
+                [state](const DrogonDbException& e) {
+                    auto errorId = ErrorLogger::generateErrorId();
+                    ErrorLogger::logDatabaseError(errorId, "create reply", e);
+                    state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+                }
             );
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Database error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "create reply", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
         },
         post_id
     );
@@ -122,70 +125,74 @@ void ReplyController::deleteReply(const HttpRequestPtr& req,
         return;
     }
 
+    // callback、请求上下文和参数移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  DeleteReplyData{user_id, reply_id, 0});
+
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
-    // 先查询回复是否存在，以及是否是当前用户创建的
-    auto sql_check = "SELECT user_id, post_id FROM replies WHERE id = ? LIMIT 1";
-
-    dbClient->execSqlAsync(
-        sql_check,
-        [callback, user_id, reply_id, dbClient](const Result& r) {
+    // 回复的 post_id 不会改变，先用普通读取取得所属帖子并判断权限
+    sql::execAsync(
+        state->ctx, dbClient, sql::REPLY_OWNER,
+        [state, dbClient](const Result& r) {
             if (r.size() == 0) {
-                callback(ResponseUtil::error(ResponseUtil::REPLY_NOT_FOUND, "回复不存在"));
+                state->respond(ResponseUtil::error(ResponseUtil::REPLY_NOT_FOUND, "回复不存在"));
                 return;
             }
-
-            int reply_user_id = r[0]["user_id"].as<int>();
-            int post_id = r[0]["post_id"].as<int>();
-
-            // 检查权限
-            if (reply_user_id != user_id) {
-                callback(ResponseUtil::error(ResponseUtil::NO_PERMISSION, "无权限操作"));
+            if (r[0]["user_id"].as<int>() != state->data.user_id) {
+                state->respond(ResponseUtil::error(ResponseUtil::NO_PERMISSION, "无权限操作"));
                 return;
             }
 
+            state->data.post_id = r[0]["post_id"].as<int>();
+
             // 使用事务保证数据一致性
             auto transPtr = dbClient->newTransaction();
-
-            // 删除回复
-            auto sql_delete = "DELETE FROM replies WHERE id = ?";
-
-            transPtr->execSqlAsync(
-                sql_delete,
-                [callback, post_id, transPtr](const Result& r) {
-                    // 更新帖子的回复数 -1
-                    auto sql_update = "UPDATE posts SET reply_count = reply_count - 1 WHERE id = ?";
-
-                    transPtr->execSqlAsync(
-                        sql_update,
-                        [callback, transPtr](const Result& r) {
+            auto onError = [state, transPtr](const char* operation) {
+                return [state, transPtr, operation](const DrogonDbException& e) {
+                    auto errorId = ErrorLogger::generateErrorId();
+                    ErrorLogger::logDatabaseError(errorId, operation, e);
+                    // 回滚事务
+                    transPtr->rollback();
+                    state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+                };
+            };
+
+            // 带 user_id 条件删除回复，按影响行数决定是否减少回复数
+            sql::execAsync(
+                state->ctx, transPtr, sql::REPLY_DELETE,
+                [state, transPtr, onError](const Result& r) {
+                    if (r.affectedRows() == 0) {
+                        // 回复在读取之后已被并发删除
+                        transPtr->rollback();
+                        state->respond(ResponseUtil::error(ResponseUtil::REPLY_NOT_FOUND, "回复不存在"));
+                        return;
+                    }
+
+                    // 减少帖子的回复数
+                    sql::execAsync(
+                        state->ctx, transPtr, sql::POST_DECREMENT_REPLY,
+                        [state, transPtr](const Result& r) {
                             // 提交事务
-                            transPtr->commit([callback]() {
-                                callback(ResponseUtil::success(Json::Value::null, "删除成功"));
+                            transPtr->commit([state]() {
+                                PostSummaryStore::addReplyCount(state->data.post_id, -1);
+                                PostResponseCache::invalidateDetail(state->data.post_id);
+                                state->respond(ResponseUtil::success(Json::Value::null, "删除成功"));
                             });
                         },
-                        [callback, transPtr](const DrogonDbException& e) {
-                            LOG_ERROR << "Update reply count error: " << e.base().what();
-                            // 回滚事务
-                            transPtr->rollback();
-                            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                        },
-                        post_id
+                        onError("decrement reply count"),
+                        state->data.post_id
                     );
                 },
-                [callback, transPtr](const DrogonDbException& e) {
-                    LOG_ERROR << "Database error: " << e.base().what();
-                    // 回滚事务
-                    transPtr->rollback();
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
-                },
-                reply_id
+                onError("delete reply"),
+                state->data.reply_id, state->data.user_id
             );
         },
-        [callback](const DrogonDbException& e) {
-            LOG_ERROR << "Database error: " << e.base().what();
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误"));
+        [state](const DrogonDbException& e) {
+            auto errorId = ErrorLogger::generateErrorId();
+            ErrorLogger::logDatabaseError(errorId, "query reply owner", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
         },
         reply_id
     );
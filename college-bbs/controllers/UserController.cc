@@ -1,14 +1,51 @@
 #include "UserController.h"
 #include "../utils/ResponseUtil.h"
+#include "../utils/SqlStatements.h"
+#include "../utils/RequestContext.h"
 #include "../utils/JwtUtil.h"
 #include "../utils/PasswordUtil.h"
 #include "../utils/ErrorLogger.h"
+#include "../utils/UsernameFilter.h"
+#include "../utils/UserNameCache.h"
+#include "../utils/RedisCache.h"
+#include "../utils/HandlerState.h"
+#include "../models/UserRows.h"
+#include "../filters/LoginRateLimitFilter.h"
 #include <drogon/orm/DbClient.h>
 #include <regex>
 
 using namespace api::v1;
 using namespace drogon::orm;
 
+namespace {
+
+/**
+ * 是否为唯一约束冲突（MySQL错误1062）
+ */
+bool isDuplicateEntry(const DrogonDbException& e) {
+    return std::string(e.base().what()).find("Duplicate entry") != std::string::npos;
+}
+
+// 注册的请求参数（插入成功后加入用户名过滤器）
+struct RegisterData {
+    std::string username;
+};
+
+// 登录的请求参数（登录成功时需要原始请求清除限流计数）
+struct LoginData {
+    HttpRequestPtr req;
+    std::string username;
+    std::string password;
+};
+
+// 查询用户信息的请求参数
+struct UserInfoData {
+    int user_id;
+    std::string redisKey;
+};
+
+} // namespace
+
 void UserController::register_(const HttpRequestPtr& req,
                                std::function<void(const HttpResponsePtr&)>&& callback) {
     // 解析JSON请求体
@@ -52,49 +89,40 @@ void UserController::register_(const HttpRequestPtr& req,
     // 获取数据库客户端
     auto dbClient = drogon::app().getDbClient();
 
-    // 检查用户名是否已存在
-    auto sql_check = "SELECT id FROM users WHERE username = ? LIMIT 1";
+    // 密码加密
+    std::string password_hash = PasswordUtil::hashPassword(password);
+
+    // callback、请求上下文和用户名移入共享状态，两个回调只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req), RegisterData{username});
+
+    // 直接插入，用户名重复由 users.username 的唯一约束判断（省去一次查询）
+    sql::execAsync(
+        state->ctx, dbClient, sql::USER_INSERT,
+        [state](const Result& r) {
+            // 获取插入的用户ID
+            auto insert_id = r.insertId();
+
+            // 加入用户名过滤器，使新用户可以立即登录
+            UsernameFilter::add(state->data.username);
+            UserNameCache::put(static_cast<int>(insert_id), state->data.username);
+
+            Json::Value data;
+            data["user_id"] = static_cast<int>(insert_id);
 
-    dbClient->execSqlAsync(
-        sql_check,
-        [callback, username, password, email, dbClient](const Result& r) {
-            if (r.size() > 0) {
+            state->respond(ResponseUtil::success(data, "注册成功"));
+        },
+        [state](const DrogonDbException& e) {
+            if (isDuplicateEntry(e)) {
                 // 用户名已存在
-                callback(ResponseUtil::error(ResponseUtil::USER_EXISTS, "用户名已存在"));
+                state->respond(ResponseUtil::error(ResponseUtil::USER_EXISTS, "用户名已存在"));
                 return;
             }
 
-            // 密码加密
-            std::string password_hash = PasswordUtil::hashPassword(password);
-
-            // 插入用户数据
-            auto sql_insert = "INSERT INTO users (username, password_hash, email) VALUES (?, ?, ?)";
-
-            dbClient->execSqlAsync(
-                sql_insert,
-                [callback](const Result& r) {
-                    // 获取插入的用户ID
-                    auto insert_id = r.insertId();
-
-                    Json::Value data;
-                    data["user_id"] = static_cast<int>(insert_id);
-
-                    callback(ResponseUtil::success(data, "注册成功"));
-                },
-                [callback](const DrogonDbException& e) {
-                    auto errorId = ErrorLogger::generateErrorId();
-                    ErrorLogger::logDatabaseError(errorId, "insert user", e);
-                    callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
-                },
-                username, password_hash, email
-            );
-        },
-        [callback](const DrogonDbException& e) {
             auto errorId = ErrorLogger::generateErrorId();
-            ErrorLogger::logDatabaseError(errorId, "check username existence", e);
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+            ErrorLogger::logDatabaseError(errorId, "insert user", e);
+            state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
         },
-        username
+        username, password_hash, email
     );
 }
 
@@ -117,49 +145,62 @@ void UserController::login(const HttpRequestPtr& req,
         return;
     }
 
-    // 获取数据库客户端
-    auto dbClient = drogon::app().getDbClient();
-
-    // 查询用户
-    auto sql = "SELECT id, username, password_hash FROM users WHERE username = ? LIMIT 1";
-
-    dbClient->execSqlAsync(
-        sql,
-        [callback, password](const Result& r) {
-            if (r.size() == 0) {
-                // 用户不存在
-                callback(ResponseUtil::error(ResponseUtil::USER_NOT_FOUND, "用户不存在"));
-                return;
-            }
-
-            auto row = r[0];
-            int user_id = row["id"].as<int>();
-            std::string db_username = row["username"].as<std::string>();
-            std::string password_hash = row["password_hash"].as<std::string>();
-
-            // 验证密码
-            if (!PasswordUtil::verifyPassword(password, password_hash)) {
-                callback(ResponseUtil::error(ResponseUtil::WRONG_PASSWORD, "密码错误"));
-                return;
-            }
-
-            // 生成JWT Token
-            std::string token = JwtUtil::generateToken(user_id, db_username);
-
-            Json::Value data;
-            data["user_id"] = user_id;
-            data["username"] = db_username;
-            data["token"] = token;
-
-            callback(ResponseUtil::success(data, "登录成功"));
-        },
-        [callback](const DrogonDbException& e) {
-            auto errorId = ErrorLogger::generateErrorId();
-            ErrorLogger::logDatabaseError(errorId, "query user login", e);
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
-        },
-        username
-    );
+    // callback、请求上下文和参数移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  LoginData{req, std::move(username), std::move(password)});
+
+    // 过滤器判定用户名一定不存在时不查询数据库
+    UsernameFilter::mightExist(state->data.username, [state](bool mightExist) {
+        if (!mightExist) {
+            state->respond(ResponseUtil::error(ResponseUtil::USER_NOT_FOUND, "用户不存在"));
+            return;
+        }
+
+        // 获取数据库客户端
+        auto dbClient = drogon::app().getDbClient();
+
+        // 查询用户
+        sql::execAsync(
+            state->ctx, dbClient, sql::USER_LOGIN,
+            [state](const Result& r) {
+                if (r.size() == 0) {
+                    // 用户不存在
+                    state->respond(ResponseUtil::error(ResponseUtil::USER_NOT_FOUND, "用户不存在"));
+                    return;
+                }
+
+                auto row = sql::firstRow<models::UserLoginRow>(r);
+                int user_id = row.id;
+                std::string db_username = std::move(row.username);
+                std::string password_hash = std::move(row.password_hash);
+
+                // 验证密码
+                if (!PasswordUtil::verifyPassword(state->data.password, password_hash)) {
+                    state->respond(ResponseUtil::error(ResponseUtil::WRONG_PASSWORD, "密码错误"));
+                    return;
+                }
+
+                // 登录成功不计入登录尝试次数
+                LoginRateLimitFilter::loginSucceeded(state->data.req, state->data.username);
+
+                // 生成JWT Token
+                std::string token = JwtUtil::generateToken(user_id, db_username);
+
+                Json::Value data;
+                data["user_id"] = user_id;
+                data["username"] = db_username;
+                data["token"] = token;
+
+                state->respond(ResponseUtil::success(data, "登录成功"));
+            },
+            [state](const DrogonDbException& e) {
+                auto errorId = ErrorLogger::generateErrorId();
+                ErrorLogger::logDatabaseError(errorId, "query user login", e);
+                state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+            },
+            state->data.username
+        );
+    });
 }
 
 void UserController::getUserInfo(const HttpRequestPtr& req,
@@ -167,53 +208,42 @@ void UserController::getUserInfo(const HttpRequestPtr& req,
     // 从request attributes中获取用户信息（由AuthFilter设置）
     auto user_id = req->attributes()->get<int>("user_id");
 
-    // 获取数据库客户端
-    auto dbClient = drogon::app().getDbClient();
-
-    // 查询用户信息和统计数据
-    auto sql = R"(
-        SELECT
-            u.id,
-            u.username,
-            u.email,
-            u.avatar_url,
-            u.created_at,
-            (SELECT COUNT(*) FROM posts WHERE user_id = u.id) as post_count,
-            (SELECT COUNT(*) FROM replies WHERE user_id = u.id) as reply_count
-        FROM users u
-        WHERE u.id = ?
-        LIMIT 1
-    )";
-
-    dbClient->execSqlAsync(
-        sql,
-        [callback](const Result& r) {
-            if (r.size() == 0) {
-                callback(ResponseUtil::error(ResponseUtil::USER_NOT_FOUND, "用户不存在"));
-                return;
-            }
-
-            auto row = r[0];
-
-            Json::Value data;
-            data["user_id"] = row["id"].as<int>();
-            data["username"] = row["username"].as<std::string>();
-            data["email"] = row["email"].as<std::string>();
-            data["avatar_url"] = row["avatar_url"].as<std::string>();
-            data["post_count"] = row["post_count"].as<int>();
-            data["reply_count"] = row["reply_count"].as<int>();
-
-            // 格式化时间
-            auto created_at = row["created_at"].as<std::string>();
-            data["created_at"] = created_at;
-
-            callback(ResponseUtil::success(data));
-        },
-        [callback](const DrogonDbException& e) {
-            auto errorId = ErrorLogger::generateErrorId();
-            ErrorLogger::logDatabaseError(errorId, "query user info", e);
-            callback(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
-        },
-        user_id
-    );
+    // callback、请求上下文和参数移入共享状态，各层闭包只持有指针
+    auto state = makeHandlerState(std::move(callback), RequestContext::get(req),
+                                  UserInfoData{user_id, "user:info:" + std::to_string(user_id)});
+
+    // 先查二级缓存（发帖数、回复数最多延迟 profile_ttl_ms）
+    RedisCache::get(state->data.redisKey, [state](const RedisCache::Value& cached) {
+        if (cached) {
+            state->respond(ResponseUtil::successRaw(*cached));
+            return;
+        }
+
+        // 获取数据库客户端
+        auto dbClient = drogon::app().getDbClient();
+
+        // 查询用户信息和统计数据
+        sql::execAsync(
+            state->ctx, dbClient, sql::USER_INFO,
+            [state](const Result& r) {
+                if (r.size() == 0) {
+                    state->respond(ResponseUtil::error(ResponseUtil::USER_NOT_FOUND, "用户不存在"));
+                    return;
+                }
+
+                // 直接序列化为data字段
+                auto data = json::toJson(sql::firstRow<models::UserInfoRow>(r));
+
+                // 写入二级缓存，响应直接使用同一份序列化结果
+                RedisCache::set(state->data.redisKey, data, RedisCache::profileTtl());
+                state->respond(ResponseUtil::successRaw(data));
+            },
+            [state](const DrogonDbException& e) {
+                auto errorId = ErrorLogger::generateErrorId();
+                ErrorLogger::logDatabaseError(errorId, "query user info", e);
+                state->respond(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误", errorId));
+            },
+            state->data.user_id
+        );
+    });
 }
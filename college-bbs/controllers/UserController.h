@@ -17,8 +17,8 @@ public:
     // 用户注册 POST /api/user/register
     ADD_METHOD_TO(UserController::register_, "/api/user/register", Post);
 
-    // 用户登录 POST /api/user/login
-    ADD_METHOD_TO(UserController::login, "/api/user/login", Post);
+    // 用户登录 POST /api/user/login (按IP和用户名限流)
+    ADD_METHOD_TO(UserController::login, "/api/user/login", Post, "LoginRateLimitFilter");
 
     // 获取用户信息 GET /api/user/info (需要认证)
     ADD_METHOD_TO(UserController::getUserInfo, "/api/user/info", Get, "AuthFilter");
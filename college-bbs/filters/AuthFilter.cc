@@ -15,29 +15,15 @@ void AuthFilter::doFilter(const HttpRequestPtr& req,
         return;
     }
 
-    // Token格式: Bearer <token>
-    std::string token;
-    if (authHeader.length() >= 7 && authHeader.substr(0, 7) == "Bearer ") {
-        token = authHeader.substr(7);
-    } else {
-        token = authHeader;
-    }
-
-    // 验证Token
-    int user_id;
-    std::string username;
-
-    if (!JwtUtil::verifyToken(token, user_id, username)) {
+    // 验证Token（准入控制已验证过时直接使用缓存的结果），
+    // 验证成功后用户信息已存入request的attributes中
+    if (!JwtUtil::verifyRequest(req)) {
         // Token无效或过期
         auto resp = ResponseUtil::error(ResponseUtil::TOKEN_INVALID, "Token无效或过期");
         fcb(resp);
         return;
     }
 
-    // Token验证成功，将用户信息存储到request的attributes中
-    req->attributes()->insert("user_id", user_id);
-    req->attributes()->insert("username", username);
-
     // 继续处理请求
     fccb();
 }
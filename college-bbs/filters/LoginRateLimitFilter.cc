@@ -0,0 +1,129 @@
+#include "LoginRateLimitFilter.h"
+#include "../utils/RateLimiter.h"
+#include "../utils/ResponseUtil.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <unordered_set>
+
+namespace {
+
+struct LoginLimiters {
+    bool enabled = false;
+    bool trustForwardedFor = false;
+    std::unordered_set<std::string> trustedProxies;
+    std::unique_ptr<RateLimiter> byIp;
+    std::unique_ptr<RateLimiter> byUsername;
+};
+
+const LoginLimiters& limiters() {
+    static const LoginLimiters instance = [] {
+        const auto& c = drogon::app().getCustomConfig()["login_rate_limit"];
+        LoginLimiters result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.trustForwardedFor = c.get("trust_x_forwarded_for", false).asBool();
+        if (c.isMember("trusted_proxies")) {
+            for (const auto& ip : c["trusted_proxies"]) {
+                result.trustedProxies.insert(ip.asString());
+            }
+        } else {
+            // 默认信任本机的反向代理（README 中的 Nginx 部署方式）
+            result.trustedProxies = {"127.0.0.1", "::1"};
+        }
+
+        RateLimiter::Options options;
+        options.mode = c.get("mode", "exact").asString() == "sketch"
+            ? RateLimiter::Mode::SKETCH
+            : RateLimiter::Mode::EXACT;
+        options.windowSeconds = c.get("window_seconds", 60).asDouble();
+        options.maxKeys = c.get("max_keys", 100000).asUInt64();
+        options.sketchWidth = c.get("sketch_width", 16384).asUInt64();
+        options.sketchDepth = c.get("sketch_depth", 4).asUInt64();
+
+        options.limit = c.get("per_ip", 20).asUInt();
+        result.byIp = std::make_unique<RateLimiter>(options);
+
+        options.limit = c.get("per_username", 5).asUInt();
+        result.byUsername = std::make_unique<RateLimiter>(options);
+        return result;
+    }();
+    return instance;
+}
+
+/**
+ * 客户端IP
+ * 对端是受信任的反向代理（或配置了 trust_x_forwarded_for）时取代理传来的地址：
+ * 优先 X-Real-IP，其次 X-Forwarded-For 的最后一个地址（由最近一跳代理追加，客户端无法伪造）
+ */
+std::string clientIp(const HttpRequestPtr& req, const LoginLimiters& l) {
+    auto peer = req->peerAddr().toIp();
+    if (!l.trustForwardedFor && l.trustedProxies.count(peer) == 0) {
+        return peer;
+    }
+
+    auto ip = req->getHeader("X-Real-IP");
+    if (ip.empty()) {
+        const auto& forwarded = req->getHeader("X-Forwarded-For");
+        auto comma = forwarded.rfind(',');
+        ip = comma == std::string::npos ? forwarded : forwarded.substr(comma + 1);
+    }
+    ip.erase(std::remove(ip.begin(), ip.end(), ' '), ip.end());
+    return ip.empty() ? peer : ip;
+}
+
+/**
+ * 限流用的用户名（不区分大小写，与数据库排序规则一致）
+ */
+std::string usernameKey(std::string username) {
+    std::transform(username.begin(), username.end(), username.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return username;
+}
+
+HttpResponsePtr tooManyRequests(int retryAfter) {
+    auto resp = ResponseUtil::error(ResponseUtil::TOO_MANY_REQUESTS, "登录尝试过于频繁，请稍后再试");
+    resp->setStatusCode(k429TooManyRequests);
+    resp->addHeader("Retry-After", std::to_string(retryAfter));
+    return resp;
+}
+
+} // namespace
+
+void LoginRateLimitFilter::doFilter(const HttpRequestPtr& req,
+                                   FilterCallback&& fcb,
+                                   FilterChainCallback&& fccb) {
+    const auto& l = limiters();
+    if (!l.enabled) {
+        fccb();
+        return;
+    }
+
+    // 按IP限流
+    if (!l.byIp->allow(clientIp(req, l))) {
+        fcb(tooManyRequests(l.byIp->retryAfterSeconds()));
+        return;
+    }
+
+    // 按用户名限流
+    auto json = req->getJsonObject();
+    if (json) {
+        std::string username = usernameKey(json->get("username", "").asString());
+        if (!username.empty() && !l.byUsername->allow(username)) {
+            fcb(tooManyRequests(l.byUsername->retryAfterSeconds()));
+            return;
+        }
+    }
+
+    // 继续处理请求
+    fccb();
+}
+
+void LoginRateLimitFilter::loginSucceeded(const HttpRequestPtr& req, const std::string& username) {
+    const auto& l = limiters();
+    if (!l.enabled) {
+        return;
+    }
+    l.byIp->release(clientIp(req, l));
+    l.byUsername->release(usernameKey(username));
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <drogon/HttpFilter.h>
+
+using namespace drogon;
+
+/**
+ * 登录限流过滤器
+ * 按客户端IP和用户名限制登录尝试次数，超出限制时在查询数据库前直接拒绝。
+ * 登录成功的请求不计入（撤销本次计数），只有失败的尝试会耗尽额度
+ *
+ * 部署在反向代理之后时，对端地址在 trusted_proxies 中（默认本机）的请求
+ * 按代理传来的 X-Real-IP / X-Forwarded-For 取客户端IP，否则所有客户端共用代理的IP
+ *
+ * 配置见 config.json 的 custom_config.login_rate_limit
+ */
+class LoginRateLimitFilter : public HttpFilter<LoginRateLimitFilter> {
+public:
+    LoginRateLimitFilter() {}
+
+    void doFilter(const HttpRequestPtr& req,
+                 FilterCallback&& fcb,
+                 FilterChainCallback&& fccb) override;
+
+    /**
+     * 登录成功：撤销该请求在IP和用户名限流中的计数
+     */
+    static void loginSucceeded(const HttpRequestPtr& req, const std::string& username);
+};
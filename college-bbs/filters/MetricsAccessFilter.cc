@@ -0,0 +1,60 @@
+#include "MetricsAccessFilter.h"
+#include "../utils/ResponseUtil.h"
+#include <drogon/drogon.h>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+struct MetricsAccess {
+    std::unordered_set<std::string> allowIps;
+    std::string token;
+};
+
+const MetricsAccess& access() {
+    static const MetricsAccess instance = [] {
+        const auto& c = drogon::app().getCustomConfig()["metrics"];
+        MetricsAccess result;
+        if (c.isMember("allow_ips")) {
+            for (const auto& ip : c["allow_ips"]) {
+                result.allowIps.insert(ip.asString());
+            }
+        } else {
+            result.allowIps = {"127.0.0.1", "::1"};
+        }
+        result.token = c.get("token", "").asString();
+        return result;
+    }();
+    return instance;
+}
+
+/**
+ * 请求是否经反向代理转发（代理会附加客户端地址，此时对端地址是代理自己）
+ */
+bool isProxied(const HttpRequestPtr& req) {
+    return !req->getHeader("X-Forwarded-For").empty() || !req->getHeader("X-Real-IP").empty();
+}
+
+} // namespace
+
+void MetricsAccessFilter::doFilter(const HttpRequestPtr& req,
+                                  FilterCallback&& fcb,
+                                  FilterChainCallback&& fccb) {
+    const auto& a = access();
+
+    // 携带抓取令牌：Authorization: Bearer <token>
+    if (!a.token.empty() && req->getHeader("Authorization") == "Bearer " + a.token) {
+        fccb();
+        return;
+    }
+
+    // 白名单地址直接访问（经代理转发的公网请求对端地址是代理本机，不算）
+    if (!isProxied(req) && a.allowIps.count(req->peerAddr().toIp()) > 0) {
+        fccb();
+        return;
+    }
+
+    auto resp = ResponseUtil::error(ResponseUtil::NO_PERMISSION, "无权访问运行指标");
+    resp->setStatusCode(k403Forbidden);
+    fcb(resp);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <drogon/HttpFilter.h>
+
+using namespace drogon;
+
+/**
+ * 指标访问过滤器
+ * /metrics 暴露各路由、各SQL语句的内部数据，只允许本机/内网抓取或携带抓取令牌的请求
+ *
+ * 配置见 config.json 的 custom_config.metrics
+ */
+class MetricsAccessFilter : public HttpFilter<MetricsAccessFilter> {
+public:
+    MetricsAccessFilter() {}
+
+    void doFilter(const HttpRequestPtr& req,
+                 FilterCallback&& fcb,
+                 FilterChainCallback&& fccb) override;
+};
@@ -1,4 +1,18 @@
 #include <drogon/drogon.h>
+#include "utils/AdmissionController.h"
+#include "utils/LikedPostCache.h"
+#include "utils/Metrics.h"
+#include "utils/PostPurger.h"
+#include "utils/PostResponseCache.h"
+#include "utils/ProcessSupervisor.h"
+#include "utils/ReplyWriteCoalescer.h"
+#include "utils/RequestTracer.h"
+#include "utils/SqlStatements.h"
+#include "utils/UsernameFilter.h"
+#include "utils/ViewCounter.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
 
 int main(int argc, char *argv[]) {
     // Load config file - use relative path for portability
@@ -9,7 +23,71 @@ int main(int argc, char *argv[]) {
         config_file = argv[1];
     }
 
-    drogon::app().loadConfigFile(config_file);
+    // JSON配置文件先自行解析：多进程模式下主进程只做监管，不初始化框架（见 ProcessSupervisor）
+    Json::Value config;
+    std::ifstream file(config_file);
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    bool isJson = config_file.size() > 5 && config_file.compare(config_file.size() - 5, 5, ".json") == 0;
+    if (isJson && file && Json::parseFromStream(builder, file, &config, &errors)) {
+        if (ProcessSupervisor::isSupervisor(config)) {
+            return ProcessSupervisor::run(argv, config);
+        }
+        ProcessSupervisor::configureWorker(config);
+        drogon::app().loadConfigJson(std::move(config));
+    } else {
+        drogon::app().loadConfigFile(config_file);
+    }
+
+    // 启动后预热SQL语句，提前发现与表结构不匹配的语句；
+    // 开始探测IO线程排队延迟，启动请求追踪的写文件线程，加载用户名过滤器，后台清除已删除的帖子；
+    // 多进程模式下最后绑定IO线程并通知监管进程已就绪
+    drogon::app().registerBeginningAdvice([]() {
+        sql::warmUp(drogon::app().getDbClient());
+        UsernameFilter::start(drogon::app().getDbClient());
+        ReplyWriteCoalescer::start(drogon::app().getDbClient());
+        ViewCounter::start(drogon::app().getDbClient());
+        PostPurger::start(drogon::app().getDbClient());
+        PostResponseCache::start();
+        LikedPostCache::start();
+        Metrics::startLoopLagProbe();
+        RequestTracer::start();
+        ProcessSupervisor::workerStarted();
+    });
+
+    // 请求指标和追踪：路由前创建请求上下文，发送响应前记录
+    // （不用pre/post-handling，使被过滤器拒绝的请求也能被统计）
+    drogon::app().registerPreRoutingAdvice([](const drogon::HttpRequestPtr& req) {
+        Metrics::requestStarted(req);
+    });
+
+    // 准入控制：数据库过载时在路由前按优先级拒绝请求（503 + Retry-After）
+    drogon::app().registerPreRoutingAdvice([](const drogon::HttpRequestPtr& req,
+                                              drogon::AdviceCallback&& acb,
+                                              drogon::AdviceChainCallback&& accb) {
+        if (auto resp = AdmissionController::admit(req)) {
+            acb(resp);
+            return;
+        }
+        accb();
+    });
+    drogon::app().registerPreSendingAdvice([](const drogon::HttpRequestPtr& req,
+                                              const drogon::HttpResponsePtr& resp) {
+        Metrics::requestFinished(req, resp);
+        RequestTracer::requestFinished(req, resp);
+    });
+
+    // 收到 SIGTERM 时先写回尚未写回的浏览次数再退出（数据库无响应时最多等待5秒）
+    // 处理函数可能在信号上下文中调用，与默认的 quit() 一样只向主循环排队
+    drogon::app().setTermSignalHandler([]() {
+        drogon::app().getLoop()->queueInLoop([]() {
+            auto quitOnce = [once = std::make_shared<std::once_flag>()]() {
+                std::call_once(*once, []() { drogon::app().quit(); });
+            };
+            ViewCounter::flush(quitOnce);
+            drogon::app().getLoop()->runAfter(5.0, quitOnce);
+        });
+    });
 
     // Run HTTP framework, the method will block in the internal event loop
     drogon::app().run();
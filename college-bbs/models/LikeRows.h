@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../utils/RowMapper.h"
+#include <array>
+
+namespace models {
+
+/**
+ * 用户点赞过的帖子（like.posts_by_user）
+ */
+struct LikedPostRow {
+    int post_id;
+
+    static constexpr const char* NAME = "LikedPostRow";
+    static constexpr std::array<const char*, 1> COLUMNS{{"post_id"}};
+
+    static LikedPostRow decode(const drogon::orm::Row& row) {
+        return LikedPostRow{sql::field<int>(row, 0)};
+    }
+};
+
+} // namespace models
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../utils/JsonWriter.h"
+#include <array>
+#include <string>
+
+namespace models {
+
+/**
+ * 帖子ID（post.list_ids）
+ */
+struct PostIdRow {
+    int id;
+
+    static constexpr const char* NAME = "PostIdRow";
+    static constexpr std::array<const char*, 1> COLUMNS{{"id"}};
+
+    static PostIdRow decode(const drogon::orm::Row& row) {
+        return PostIdRow{sql::field<int>(row, 0)};
+    }
+};
+
+/**
+ * 帖子摘要（post.summaries_by_ids）
+ */
+struct PostSummaryRow {
+    int id;
+    std::string title;
+    int view_count;
+    int like_count;
+    int reply_count;
+    std::string created_at;
+    int author_id;
+
+    static constexpr const char* NAME = "PostSummaryRow";
+    static constexpr std::array<const char*, 7> COLUMNS{{
+        "id", "title", "view_count", "like_count", "reply_count", "created_at", "author_id"}};
+
+    static PostSummaryRow decode(const drogon::orm::Row& row) {
+        return PostSummaryRow{
+            sql::field<int>(row, 0),
+            sql::field<std::string>(row, 1),
+            sql::field<int>(row, 2),
+            sql::field<int>(row, 3),
+            sql::field<int>(row, 4),
+            sql::field<std::string>(row, 5),
+            sql::field<int>(row, 6),
+        };
+    }
+};
+
+/**
+ * 帖子详情（post.detail）
+ */
+struct PostDetailRow {
+    int id;
+    std::string title;
+    std::string content;
+    int view_count;
+    int like_count;
+    int reply_count;
+    std::string created_at;
+    int author_id;
+    std::string author;  // 不是查询列，由用户名缓存填充
+
+    static constexpr const char* NAME = "PostDetailRow";
+    static constexpr std::array<const char*, 8> COLUMNS{{
+        "id", "title", "content", "view_count", "like_count", "reply_count", "created_at", "author_id"}};
+
+    static PostDetailRow decode(const drogon::orm::Row& row) {
+        return PostDetailRow{
+            sql::field<int>(row, 0),
+            sql::field<std::string>(row, 1),
+            sql::field<std::string>(row, 2),
+            sql::field<int>(row, 3),
+            sql::field<int>(row, 4),
+            sql::field<int>(row, 5),
+            sql::field<std::string>(row, 6),
+            sql::field<int>(row, 7),
+            std::string(),
+        };
+    }
+
+    static constexpr auto jsonFields() {
+        return std::make_tuple(json::field("author", &PostDetailRow::author),
+                               json::field("author_id", &PostDetailRow::author_id),
+                               json::field("content", &PostDetailRow::content),
+                               json::field("created_at", &PostDetailRow::created_at),
+                               json::field("id", &PostDetailRow::id),
+                               json::field("like_count", &PostDetailRow::like_count),
+                               json::field("reply_count", &PostDetailRow::reply_count),
+                               json::field("title", &PostDetailRow::title),
+                               json::field("view_count", &PostDetailRow::view_count));
+    }
+};
+
+} // namespace models
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../utils/JsonWriter.h"
+#include <array>
+#include <string>
+
+namespace models {
+
+/**
+ * 帖子详情中的回复（reply.list_by_post）
+ */
+struct ReplyRow {
+    int id;
+    std::string content;
+    std::string created_at;
+    int author_id;
+    std::string author;  // 不是查询列，由用户名缓存填充
+
+    static constexpr const char* NAME = "ReplyRow";
+    static constexpr std::array<const char*, 4> COLUMNS{{"id", "content", "created_at", "author_id"}};
+
+    static ReplyRow decode(const drogon::orm::Row& row) {
+        return ReplyRow{
+            sql::field<int>(row, 0),
+            sql::field<std::string>(row, 1),
+            sql::field<std::string>(row, 2),
+            sql::field<int>(row, 3),
+            std::string(),
+        };
+    }
+
+    static constexpr auto jsonFields() {
+        return std::make_tuple(json::field("author", &ReplyRow::author),
+                               json::field("author_id", &ReplyRow::author_id),
+                               json::field("content", &ReplyRow::content),
+                               json::field("created_at", &ReplyRow::created_at),
+                               json::field("id", &ReplyRow::id));
+    }
+};
+
+} // namespace models
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../utils/JsonWriter.h"
+#include <array>
+#include <string>
+
+namespace models {
+
+/**
+ * 用户ID和用户名（user.names_after / user.names_by_ids）
+ */
+struct UserNameRow {
+    int id;
+    std::string username;
+
+    static constexpr const char* NAME = "UserNameRow";
+    static constexpr std::array<const char*, 2> COLUMNS{{"id", "username"}};
+
+    static UserNameRow decode(const drogon::orm::Row& row) {
+        return UserNameRow{sql::field<int>(row, 0), sql::field<std::string>(row, 1)};
+    }
+};
+
+/**
+ * 登录校验（user.login）
+ */
+struct UserLoginRow {
+    int id;
+    std::string username;
+    std::string password_hash;
+
+    static constexpr const char* NAME = "UserLoginRow";
+    static constexpr std::array<const char*, 3> COLUMNS{{"id", "username", "password_hash"}};
+
+    static UserLoginRow decode(const drogon::orm::Row& row) {
+        return UserLoginRow{
+            sql::field<int>(row, 0),
+            sql::field<std::string>(row, 1),
+            sql::field<std::string>(row, 2),
+        };
+    }
+};
+
+/**
+ * 用户信息和统计（user.info）
+ */
+struct UserInfoRow {
+    int id;
+    std::string username;
+    std::string email;
+    std::string avatar_url;
+    std::string created_at;
+    int post_count;
+    int reply_count;
+
+    static constexpr const char* NAME = "UserInfoRow";
+    static constexpr std::array<const char*, 7> COLUMNS{{
+        "id", "username", "email", "avatar_url", "created_at", "post_count", "reply_count"}};
+
+    static UserInfoRow decode(const drogon::orm::Row& row) {
+        return UserInfoRow{
+            sql::field<int>(row, 0),
+            sql::field<std::string>(row, 1),
+            sql::field<std::string>(row, 2),
+            sql::field<std::string>(row, 3),
+            sql::field<std::string>(row, 4),
+            sql::field<int>(row, 5),
+            sql::field<int>(row, 6),
+        };
+    }
+
+    // 用户信息接口的data字段（id 输出为 user_id）
+    static constexpr auto jsonFields() {
+        return std::make_tuple(json::field("avatar_url", &UserInfoRow::avatar_url),
+                               json::field("created_at", &UserInfoRow::created_at),
+                               json::field("email", &UserInfoRow::email),
+                               json::field("post_count", &UserInfoRow::post_count),
+                               json::field("reply_count", &UserInfoRow::reply_count),
+                               json::field("user_id", &UserInfoRow::id),
+                               json::field("username", &UserInfoRow::username));
+    }
+};
+
+} // namespace models
@@ -34,8 +34,9 @@ CREATE TABLE IF NOT EXISTS posts (
     reply_count INT DEFAULT 0 COMMENT '回复数',
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '发帖时间',
     updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '更新时间',
-    INDEX idx_user_id (user_id),
-    INDEX idx_created_at (created_at),
+    deleted_at TIMESTAMP NULL DEFAULT NULL COMMENT '删除时间（软删除，回复和点赞由后台清除）',
+    INDEX idx_deleted_created (deleted_at, created_at) COMMENT '帖子列表、后台清除',
+    INDEX idx_user_deleted (user_id, deleted_at) COMMENT '用户发帖数',
     FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='帖子表';
 
@@ -48,8 +49,8 @@ CREATE TABLE IF NOT EXISTS replies (
     user_id INT NOT NULL COMMENT '回复用户ID',
     content TEXT NOT NULL COMMENT '回复内容',
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '回复时间',
-    INDEX idx_post_id (post_id),
-    INDEX idx_user_id (user_id),
+    INDEX idx_post_created (post_id, created_at) COMMENT '回复列表按时间排序',
+    INDEX idx_user_post (user_id, post_id) COMMENT '用户回复数',
     FOREIGN KEY (post_id) REFERENCES posts(id) ON DELETE CASCADE,
     FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='回复表';
@@ -63,8 +64,7 @@ CREATE TABLE IF NOT EXISTS post_likes (
     user_id INT NOT NULL COMMENT '用户ID',
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '点赞时间',
     UNIQUE KEY uk_post_user (post_id, user_id) COMMENT '同一用户只能点赞一次',
-    INDEX idx_post_id (post_id),
-    INDEX idx_user_id (user_id),
+    INDEX idx_user_post (user_id, post_id) COMMENT '用户点赞的帖子',
     FOREIGN KEY (post_id) REFERENCES posts(id) ON DELETE CASCADE,
     FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='点赞表';
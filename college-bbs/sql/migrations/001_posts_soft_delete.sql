@@ -0,0 +1,9 @@
+-- 计算机学院贴吧系统 - 数据库迁移
+-- 帖子软删除：删帖只标记 deleted_at，回复和点赞由后台分批清除（PostPurger）
+-- 已按新版 init_database.sql 建库的不需要执行
+
+USE college_bbs;
+
+ALTER TABLE posts
+    ADD COLUMN deleted_at TIMESTAMP NULL DEFAULT NULL COMMENT '删除时间（软删除，回复和点赞由后台清除）' AFTER updated_at,
+    ADD INDEX idx_deleted_at (deleted_at);
@@ -0,0 +1,35 @@
+-- 计算机学院贴吧系统 - 数据库迁移
+-- 热点查询的复合索引（需先执行 001_posts_soft_delete.sql）
+-- 已按新版 init_database.sql 建库的不需要执行
+--
+-- InnoDB 二级索引自带主键列。标 * 的是覆盖索引（只读索引列和主键）；
+-- 其余的只负责过滤和排序，按索引顺序回表读取其他列，不再 filesort：
+-- - 帖子列表：WHERE deleted_at IS NULL ORDER BY created_at DESC        -> posts(deleted_at, created_at)
+-- - 帖子总数 *：WHERE deleted_at IS NULL                               -> 同上
+-- - 后台清除 *：WHERE deleted_at IS NOT NULL ORDER BY deleted_at        -> 同上
+-- - 用户发帖数 *：WHERE user_id = ? AND deleted_at IS NULL             -> posts(user_id, deleted_at)
+-- - 回复列表：WHERE post_id = ? ORDER BY created_at（需读 content）     -> replies(post_id, created_at)
+-- - 用户回复数：WHERE user_id = ?（再按 post_id 关联帖子）              -> replies(user_id, post_id)
+-- - 用户点赞的帖子 *：WHERE user_id = ?                                -> post_likes(user_id, post_id)
+-- 被替代的单列索引一并删除（外键由新索引的首列满足）
+
+USE college_bbs;
+
+ALTER TABLE posts
+    ADD INDEX idx_deleted_created (deleted_at, created_at),
+    ADD INDEX idx_user_deleted (user_id, deleted_at),
+    DROP INDEX idx_deleted_at,
+    DROP INDEX idx_created_at,
+    DROP INDEX idx_user_id;
+
+ALTER TABLE replies
+    ADD INDEX idx_post_created (post_id, created_at),
+    ADD INDEX idx_user_post (user_id, post_id),
+    DROP INDEX idx_post_id,
+    DROP INDEX idx_user_id;
+
+-- (post_id, user_id) 由唯一索引 uk_post_user 覆盖
+ALTER TABLE post_likes
+    ADD INDEX idx_user_post (user_id, post_id),
+    DROP INDEX idx_post_id,
+    DROP INDEX idx_user_id;
@@ -1,16 +1,486 @@
 #define DROGON_TEST_MAIN
 #include <drogon/drogon_test.h>
 #include <drogon/drogon.h>
+#include "../utils/HandlerState.h"
+#include "../utils/RequestContext.h"
+#include "../utils/ResponseCache.h"
+#include "../utils/PostResponseCache.h"
+#include "../utils/RedisCache.h"
+#include "../utils/LatencyHistogram.h"
+#include "../utils/RateLimiter.h"
+#include "../models/ReplyRows.h"
+#include "../utils/RoaringBitmap.h"
+#include "../utils/SqlStatements.h"
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <unistd.h>
+
+// 统计本线程的堆分配次数（替换全局 operator new）
+static thread_local uint64_t g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    g_allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
 
 DROGON_TEST(BasicTest)
 {
     // Add your tests here
 }
 
+namespace {
+
+/**
+ * 测试用数据库客户端：与 DbClient::execSqlAsync 一样把两个回调存入 std::function，
+ * 不执行SQL，finish() 时按发出顺序以空结果调用结果回调（回调中发出的查询也会完成）
+ */
+class StubDbClient {
+public:
+    StubDbClient() { pending_.reserve(4); }
+
+    template <typename ResultCb, typename ErrorCb, typename... Args>
+    void execSqlAsync(const std::string& sql, ResultCb&& callback, ErrorCb&& errorCallback, Args&&... args) {
+        pending_.push_back(Query{drogon::orm::ResultCallback(std::forward<ResultCb>(callback)),
+                                 drogon::orm::ExceptionCallback(std::forward<ErrorCb>(errorCallback))});
+    }
+
+    void finish() {
+        for (size_t i = 0; i < pending_.size(); i++) {
+            auto callback = std::move(pending_[i].callback);
+            callback(drogon::orm::Result(nullptr));
+        }
+        pending_.clear();
+    }
+
+private:
+    struct Query {
+        drogon::orm::ResultCallback callback;
+        drogon::orm::ExceptionCallback errorCallback;
+    };
+    std::vector<Query> pending_;
+};
+
+// 与 ReplyController::create 的请求参数相同
+struct CreateReplyData {
+    int user_id;
+    int post_id;
+    std::string content;
+};
+
+} // namespace
+
+// 按 ReplyController::create 的回调链（检查帖子存在 → 写入回复 → 响应），
+// 通过真实的 sql::execAsync 和 HandlerState 在测试用客户端上执行，
+// 比较每层按值捕获 callback 和参数与改用共享处理状态的堆分配次数
+DROGON_TEST(HandlerStateAllocations)
+{
+    int responses = 0;
+    auto req = drogon::HttpRequest::newHttpJsonRequest(Json::Value());
+    // 与框架的 callback 一样持有请求和连接，复制时需要分配
+    auto makeCallback = [&responses, req]() {
+        auto connection = std::make_shared<int>(0);
+        return std::function<void(const drogon::HttpResponsePtr&)>(
+            [&responses, req, connection](const drogon::HttpResponsePtr&) { responses++; });
+    };
+    auto client = std::make_shared<StubDbClient>();
+    int user_id = 1;
+    int post_id = 2;
+
+    // 旧写法：每层按值捕获 callback 和参数
+    auto byValueChain = [&](std::function<void(const drogon::HttpResponsePtr&)> callback,
+                            const RequestContextPtr& ctx, std::string content) {
+        sql::execAsync(
+            ctx, client, sql::POST_EXISTS,
+            [callback, ctx, client, user_id, post_id, content](const drogon::orm::Result& r) {
+                sql::execAsync(
+                    ctx, client, sql::REPLY_INSERT,
+                    [callback](const drogon::orm::Result& r) {
+                        callback(nullptr);
+                    },
+                    [callback](const drogon::orm::DrogonDbException& e) {
+                        callback(nullptr);
+                    },
+                    post_id, user_id, content
+                );
+            },
+            [callback](const drogon::orm::DrogonDbException& e) {
+                callback(nullptr);
+            },
+            post_id
+        );
+        client->finish();
+    };
+
+    // 新写法：与 ReplyController::create 相同，callback、上下文和参数移入共享状态
+    auto sharedChain = [&](std::function<void(const drogon::HttpResponsePtr&)> callback,
+                           const RequestContextPtr& ctx, std::string content) {
+        auto state = makeHandlerState(std::move(callback), ctx,
+                                      CreateReplyData{user_id, post_id, std::move(content)});
+        sql::execAsync(
+            state->ctx, client, sql::POST_EXISTS,
+            [state, client](const drogon::orm::Result& r) {
+                auto& data = state->data;
+                sql::execAsync(
+                    state->ctx, client, sql::REPLY_INSERT,
+                    [state](const drogon::orm::Result& r) {
+                        state->respond(nullptr);
+                        // 只有第一次响应生效
+                        state->respond(nullptr);
+                    },
+                    [state](const drogon::orm::DrogonDbException& e) {
+                        state->respond(nullptr);
+                    },
+                    data.post_id, data.user_id, data.content
+                );
+            },
+            [state](const drogon::orm::DrogonDbException& e) {
+                state->respond(nullptr);
+            },
+            post_id
+        );
+        client->finish();
+    };
+
+    // 统计本次调用的分配次数（callback、上下文和内容在计数前创建）
+    auto measure = [&](const auto& chain) {
+        auto callback = makeCallback();
+        auto ctx = RequestContext::create(req);
+        std::string content(1000, 'x');
+        uint64_t before = g_allocations;
+        chain(std::move(callback), ctx, std::move(content));
+        return g_allocations - before;
+    };
+
+    // 先各执行一次，排除语句统计等首次调用的分配
+    measure(byValueChain);
+    measure(sharedChain);
+    uint64_t byValue = measure(byValueChain);
+    uint64_t shared = measure(sharedChain);
+
+    CHECK(responses == 4);
+    // 按值捕获时内容复制一次、callback 复制四次（两层各两个闭包），共享状态只多一次分配
+    CHECK(byValue >= shared + 4);
+}
+
+// 读取进行中失效：旧结果不写入缓存，失效之后的请求不挂到旧的读取上
+DROGON_TEST(ResponseCacheInvalidateDuringFetch)
+{
+    using Flight = SingleFlight<int, int>;
+    static Flight flight("test_flight");
+    static ResponseCache<int, int> cache("test_cache", flight, [](const int&) { return true; });
+
+    std::vector<Flight::Done> pending;
+    auto fetch = [&pending](Flight::Done done) { pending.push_back(std::move(done)); };
+    std::vector<int> results;
+    auto collect = [&results](const Flight::ValuePtr& value) { results.push_back(*value); };
+
+    cache.get(1, fetch, collect);
+    cache.invalidate(1);
+    cache.get(1, fetch, collect);
+    CHECK(pending.size() == 2);
+
+    // 失效前开始的读取只分发给已在等待的请求
+    pending[0](std::make_shared<const int>(10));
+    CHECK(results == std::vector<int>{10});
+    pending[1](std::make_shared<const int>(20));
+    CHECK(results == (std::vector<int>{10, 20}));
+
+    // 缓存中是失效之后读取的结果
+    cache.get(1, fetch, collect);
+    CHECK(pending.size() == 2);
+    CHECK(results.back() == 20);
+
+    // clear 同样丢弃进行中读取的结果
+    cache.get(2, fetch, collect);
+    cache.clear();
+    pending[2](std::make_shared<const int>(30));
+    cache.get(2, fetch, collect);
+    CHECK(pending.size() == 4);
+}
+
+// 按字段描述拼接的JSON与 Json::Value 序列化结果逐字节一致（键顺序、转义、非ASCII字符）
+DROGON_TEST(JsonWriterMatchesJsonValue)
+{
+    std::vector<models::ReplyRow> replies{
+        {1, "第一条\"回复\"\n", "2024-11-10 08:00:00", 2, "张三"},
+        {3, "", "2024-11-10 09:00:00", 4, "li\\si"},
+    };
+    std::string written;
+    json::appendValue(written, replies);
+
+    Json::Value expected(Json::arrayValue);
+    for (const auto& reply : replies) {
+        Json::Value item;
+        item["id"] = reply.id;
+        item["content"] = reply.content;
+        item["created_at"] = reply.created_at;
+        item["author_id"] = reply.author_id;
+        item["author"] = reply.author;
+        expected.append(item);
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+
+    CHECK(written == Json::writeString(builder, expected));
+}
+
+// 撤销的计数不再占用额度（登录成功后不计入登录尝试次数）
+DROGON_TEST(RateLimiterRelease)
+{
+    for (auto mode : {RateLimiter::Mode::EXACT, RateLimiter::Mode::SKETCH}) {
+        RateLimiter::Options options;
+        options.mode = mode;
+        options.limit = 2;
+        options.windowSeconds = 3600;
+        RateLimiter limiter(options);
+
+        CHECK(limiter.allow("alice"));
+        CHECK(limiter.allow("alice"));
+        CHECK(!limiter.allow("alice"));
+
+        limiter.release("alice");
+        CHECK(limiter.allow("alice"));
+        CHECK(!limiter.allow("alice"));
+
+        // 没有计数的key撤销后也不会多出额度
+        limiter.release("bob");
+        limiter.release("bob");
+        CHECK(limiter.allow("bob"));
+        CHECK(limiter.allow("bob"));
+        CHECK(!limiter.allow("bob"));
+    }
+}
+
+// Prometheus le 桶只计入上界不超过 le 的内部桶（样本所在的桶跨过 le 时不计入）
+DROGON_TEST(LatencyHistogramCountAtOrBelow)
+{
+    LatencyHistogram histogram;
+    histogram.record(5);     // 线性区间，桶上界5
+    histogram.record(1000);  // 桶 [960, 1023]
+    histogram.record(1023);
+    histogram.record(2000);
+    auto snap = histogram.snapshot();
+
+    CHECK(snap.countAtOrBelow(4) == 0);
+    CHECK(snap.countAtOrBelow(5) == 1);
+    CHECK(snap.countAtOrBelow(1000) == 1);
+    CHECK(snap.countAtOrBelow(1022) == 1);
+    CHECK(snap.countAtOrBelow(1023) == 3);
+    CHECK(snap.countAtOrBelow(100000) == 4);
+}
+
+// 压缩位图的增删查，跨容器（高16位不同）的值互不影响
+DROGON_TEST(RoaringBitmapAddRemoveContains)
+{
+    RoaringBitmap bitmap;
+    CHECK(!bitmap.contains(1));
+    CHECK(bitmap.add(1));
+    CHECK(!bitmap.add(1));
+    CHECK(bitmap.add(65535));
+    CHECK(bitmap.add(65536));
+    CHECK(bitmap.add(UINT32_MAX));
+    CHECK(bitmap.cardinality() == 4);
+    CHECK(bitmap.contains(1));
+    CHECK(bitmap.contains(65535));
+    CHECK(bitmap.contains(65536));
+    CHECK(bitmap.contains(UINT32_MAX));
+    CHECK(!bitmap.contains(2));
+    CHECK(!bitmap.contains(65537));
+
+    CHECK(bitmap.remove(65536));
+    CHECK(!bitmap.remove(65536));
+    CHECK(!bitmap.remove(2));
+    CHECK(!bitmap.contains(65536));
+    CHECK(bitmap.contains(65535));
+    CHECK(bitmap.cardinality() == 3);
+
+    CHECK(bitmap.remove(1));
+    CHECK(bitmap.remove(65535));
+    CHECK(bitmap.remove(UINT32_MAX));
+    CHECK(bitmap.cardinality() == 0);
+    CHECK(!bitmap.contains(1));
+}
+
+// 同一容器超过4096个元素时转为位图，删回4096个时转回数组，内容不变
+DROGON_TEST(RoaringBitmapContainerSwitch)
+{
+    RoaringBitmap bitmap;
+    for (uint32_t i = 0; i < 4096; i++) {
+        CHECK(bitmap.add(i * 3));
+    }
+    CHECK(bitmap.bitmapContainers() == 0);
+    CHECK(bitmap.cardinality() == 4096);
+
+    CHECK(bitmap.add(4096 * 3));
+    CHECK(bitmap.bitmapContainers() == 1);
+    CHECK(bitmap.cardinality() == 4097);
+    CHECK(!bitmap.add(0));
+    for (uint32_t i = 0; i <= 4096; i++) {
+        CHECK(bitmap.contains(i * 3));
+        CHECK(!bitmap.contains(i * 3 + 1));
+    }
+
+    CHECK(bitmap.remove(0));
+    CHECK(bitmap.bitmapContainers() == 0);
+    CHECK(bitmap.cardinality() == 4096);
+    CHECK(!bitmap.contains(0));
+    for (uint32_t i = 1; i <= 4096; i++) {
+        CHECK(bitmap.contains(i * 3));
+    }
+    CHECK(!bitmap.remove(0));
+}
+
+// 以下测试需要Redis：设置 BBS_TEST_REDIS=host:port 后运行（本地 redis-server 即可），未设置时跳过
+
+namespace {
+
+const auto REDIS_TIMEOUT = std::chrono::seconds(3);
+
+/**
+ * 读取帖子详情，返回分发到的data（超时返回空串）
+ */
+std::string readDetail(int post_id, const std::string& fresh) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    PostResponseCache::detail(
+        post_id,
+        [fresh](PostResponseCache::Done done) { done(PostResponseCache::success(fresh)); },
+        [promise](const PostResponseCache::ResultPtr& result) { promise->set_value(result->data); });
+    if (future.wait_for(REDIS_TIMEOUT) != std::future_status::ready) {
+        return "";
+    }
+    return future.get();
+}
+
+} // namespace
+
+// 键数超过一条MGET的上限时分多条命令，结果与键一一对应；键前缀中的 % 不影响命令解析
+DROGON_TEST(RedisCacheMget)
+{
+    if (!RedisCache::enabled()) {
+        return;
+    }
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < RedisCache::MAX_KEYS_PER_MGET + 10; i++) {
+        keys.push_back("test:mget:" + std::to_string(i));
+        if (i % 2 == 0) {
+            RedisCache::set(keys.back(), "value %s " + std::to_string(i));
+        }
+    }
+
+    auto promise = std::make_shared<std::promise<std::vector<RedisCache::Value>>>();
+    auto future = promise->get_future();
+    RedisCache::mget(keys, [promise](const std::vector<RedisCache::Value>& values) {
+        promise->set_value(values);
+    });
+    REQUIRE(future.wait_for(REDIS_TIMEOUT) == std::future_status::ready);
+
+    auto values = future.get();
+    REQUIRE(values.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i % 2 == 0) {
+            CHECK(values[i] && *values[i] == "value %s " + std::to_string(i));
+        } else {
+            CHECK(!values[i]);
+        }
+    }
+}
+
+// 失效后一级、二级缓存都不再返回旧结果，失效前开始的读取写回的旧结果也不会被读到
+DROGON_TEST(PostResponseCacheInvalidation)
+{
+    if (!RedisCache::enabled()) {
+        return;
+    }
+
+    const int post_id = 1;
+    CHECK(readDetail(post_id, "v1") == "v1");
+    CHECK(readDetail(post_id, "v2") == "v1");
+
+    PostResponseCache::invalidateDetail(post_id);
+    CHECK(readDetail(post_id, "v3") == "v3");
+
+    // 读取进行中失效
+    PostResponseCache::invalidateDetail(post_id);
+    auto started = std::make_shared<std::promise<PostResponseCache::Done>>();
+    auto startedFuture = started->get_future();
+    auto delivered = std::make_shared<std::promise<std::string>>();
+    auto deliveredFuture = delivered->get_future();
+    PostResponseCache::detail(
+        post_id,
+        [started](PostResponseCache::Done done) { started->set_value(done); },
+        [delivered](const PostResponseCache::ResultPtr& result) { delivered->set_value(result->data); });
+    REQUIRE(startedFuture.wait_for(REDIS_TIMEOUT) == std::future_status::ready);
+
+    PostResponseCache::invalidateDetail(post_id);
+    startedFuture.get()(PostResponseCache::success("stale"));
+    CHECK(deliveredFuture.get() == "stale");
+    CHECK(readDetail(post_id, "v4") == "v4");
+}
+
+// 本进程发布的消息也会收到；消息原样传递
+DROGON_TEST(RedisCachePubSub)
+{
+    if (!RedisCache::enabled()) {
+        return;
+    }
+
+    auto received = std::make_shared<std::promise<std::string>>();
+    auto future = received->get_future();
+    auto once = std::make_shared<std::once_flag>();
+    RedisCache::subscribe("test:channel", [received, once](const std::string& message) {
+        std::call_once(*once, [&]() { received->set_value(message); });
+    });
+
+    // 订阅建立之前发布的消息会丢失，重复发布直到收到
+    for (int i = 0; i < 30 && future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready; i++) {
+        RedisCache::publish("test:channel", "hello %s world");
+    }
+    REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    CHECK(future.get() == "hello %s world");
+}
+
 int main(int argc, char** argv) 
 {
     using namespace drogon;
 
+    // 设置 BBS_TEST_REDIS=host:port 时启用Redis二级缓存（键前缀按进程区分，并含 % 检查命令格式）
+    if (const char* redis = std::getenv("BBS_TEST_REDIS")) {
+        std::string address(redis);
+        auto colon = address.rfind(':');
+        Json::Value client;
+        client["name"] = "default";
+        client["host"] = address.substr(0, colon);
+        client["port"] = colon == std::string::npos ? 6379 : std::stoi(address.substr(colon + 1));
+        // 单个连接：先发出的写入先执行
+        client["number_of_connections"] = 1;
+
+        Json::Value config;
+        config["redis_clients"].append(client);
+        config["custom_config"]["redis_cache"]["enabled"] = true;
+        config["custom_config"]["redis_cache"]["key_prefix"] = "bbs%test:" + std::to_string(getpid()) + ":";
+        app().loadConfigJson(config);
+    }
+
     std::promise<void> p1;
     std::future<void> f1 = p1.get_future();
 
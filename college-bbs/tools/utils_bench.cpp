@@ -0,0 +1,246 @@
+/**
+ * 工具类微基准测试
+ *
+ * 单独测量每个请求路径上都会调用的工具函数：
+ * - JwtUtil: 生成Token、验证Token（有效/签名错误/已过期）
+ * - PasswordUtil: 哈希密码、验证密码
+ * - ResponseUtil: 构造成功响应（空数据/帖子列表大小的数据）和错误响应
+ *
+ * 除耗时外，每个用例还统计每次操作的堆内存分配次数和字节数（allocs_per_op / bytes_per_op），
+ * 通过替换全局 operator new 实现
+ *
+ * 编译: cmake 找到 Google Benchmark 时自动构建
+ *
+ * 使用:
+ *   ./tools/utils_bench
+ *   ./tools/utils_bench --benchmark_filter=Jwt
+ *   ./tools/utils_bench --benchmark_format=json > utils_bench.json
+ */
+
+#include "../utils/JwtUtil.h"
+#include "../utils/PasswordUtil.h"
+#include "../utils/ResponseUtil.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// ============================================
+// 堆内存分配计数
+// ============================================
+
+static std::atomic<uint64_t> g_allocCount{0};
+static std::atomic<uint64_t> g_allocBytes{0};
+
+void* operator new(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/**
+ * 统计基准循环内的分配次数，结束时写入计数器
+ */
+class AllocationScope {
+public:
+    explicit AllocationScope(benchmark::State& state)
+        : state_(state),
+          count_(g_allocCount.load(std::memory_order_relaxed)),
+          bytes_(g_allocBytes.load(std::memory_order_relaxed)) {}
+
+    ~AllocationScope() {
+        auto count = g_allocCount.load(std::memory_order_relaxed) - count_;
+        auto bytes = g_allocBytes.load(std::memory_order_relaxed) - bytes_;
+        state_.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(count), benchmark::Counter::kAvgIterations);
+        state_.counters["bytes_per_op"] = benchmark::Counter(
+            static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    uint64_t count_;
+    uint64_t bytes_;
+};
+
+/**
+ * 构造与帖子列表接口相同结构的数据
+ */
+Json::Value makePostList(int size) {
+    Json::Value posts(Json::arrayValue);
+    for (int i = 0; i < size; i++) {
+        Json::Value post;
+        post["id"] = 100000 + i;
+        post["title"] = "C++期末复习资料分享 " + std::to_string(i);
+        post["view_count"] = 128;
+        post["like_count"] = 12;
+        post["reply_count"] = 7;
+        post["created_at"] = "2024-06-01 12:00:00";
+        post["author_id"] = 1;
+        post["author"] = "zhangsan";
+        posts.append(post);
+    }
+
+    Json::Value data;
+    data["posts"] = posts;
+    data["total"] = 100000;
+    data["page"] = 1;
+    data["size"] = size;
+    return data;
+}
+
+} // namespace
+
+// ============================================
+// JwtUtil
+// ============================================
+
+static void BM_JwtGenerateToken(benchmark::State& state) {
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JwtUtil::generateToken(1, "zhangsan"));
+    }
+}
+BENCHMARK(BM_JwtGenerateToken);
+
+static void BM_JwtVerifyValid(benchmark::State& state) {
+    auto token = JwtUtil::generateToken(1, "zhangsan");
+    int user_id;
+    std::string username;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JwtUtil::verifyToken(token, user_id, username));
+    }
+}
+BENCHMARK(BM_JwtVerifyValid);
+
+static void BM_JwtVerifyBadSignature(benchmark::State& state) {
+    auto token = JwtUtil::generateToken(1, "zhangsan");
+    token.back() = token.back() == 'A' ? 'B' : 'A';
+    int user_id;
+    std::string username;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JwtUtil::verifyToken(token, user_id, username));
+    }
+}
+BENCHMARK(BM_JwtVerifyBadSignature);
+
+static void BM_JwtVerifyMalformed(benchmark::State& state) {
+    std::string token = "not-a-jwt";
+    int user_id;
+    std::string username;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JwtUtil::verifyToken(token, user_id, username));
+    }
+}
+BENCHMARK(BM_JwtVerifyMalformed);
+
+static void BM_JwtVerifyExpired(benchmark::State& state) {
+    auto token = JwtUtil::generateToken(1, "zhangsan", -60);
+    int user_id;
+    std::string username;
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(JwtUtil::verifyToken(token, user_id, username));
+    }
+}
+BENCHMARK(BM_JwtVerifyExpired);
+
+// ============================================
+// PasswordUtil
+// ============================================
+
+static void BM_PasswordHash(benchmark::State& state) {
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordUtil::hashPassword("123456"));
+    }
+}
+BENCHMARK(BM_PasswordHash);
+
+static void BM_PasswordVerify(benchmark::State& state) {
+    auto hash = PasswordUtil::hashPassword("123456");
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordUtil::verifyPassword("123456", hash));
+    }
+}
+BENCHMARK(BM_PasswordVerify);
+
+static void BM_PasswordVerifyWrong(benchmark::State& state) {
+    auto hash = PasswordUtil::hashPassword("123456");
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordUtil::verifyPassword("654321", hash));
+    }
+}
+BENCHMARK(BM_PasswordVerifyWrong);
+
+// ============================================
+// ResponseUtil
+// ============================================
+
+static void BM_ResponseSuccessEmpty(benchmark::State& state) {
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ResponseUtil::success());
+    }
+}
+BENCHMARK(BM_ResponseSuccessEmpty);
+
+// 参数为列表长度（帖子列表默认20条，最大100条）
+static void BM_ResponseSuccessPostList(benchmark::State& state) {
+    auto data = makePostList(static_cast<int>(state.range(0)));
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ResponseUtil::success(data));
+    }
+}
+BENCHMARK(BM_ResponseSuccessPostList)->Arg(1)->Arg(20)->Arg(100);
+
+static void BM_ResponseError(benchmark::State& state) {
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ResponseUtil::error(ResponseUtil::POST_NOT_FOUND, "帖子不存在"));
+    }
+}
+BENCHMARK(BM_ResponseError);
+
+static void BM_ResponseErrorWithId(benchmark::State& state) {
+    AllocationScope allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ResponseUtil::error(ResponseUtil::DB_ERROR, "数据库错误",
+                                                     "ERR-1700000000-0300A3F2"));
+    }
+}
+BENCHMARK(BM_ResponseErrorWithId);
+
+BENCHMARK_MAIN();
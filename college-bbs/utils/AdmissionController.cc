@@ -0,0 +1,162 @@
+#include "AdmissionController.h"
+#include "JwtUtil.h"
+#include "ResponseUtil.h"
+#include <drogon/drogon.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+struct AdmissionConfig {
+    bool enabled;
+    uint64_t targetMicros;
+    int64_t intervalMicros;
+    std::array<int64_t, AdmissionController::PRIORITY_COUNT> maxInflight;
+    int retryAfterSeconds;
+};
+
+const AdmissionConfig& config() {
+    static const AdmissionConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["admission_control"];
+        const auto& limits = c["max_inflight_queries"];
+        AdmissionConfig result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.targetMicros = c.get("target_ms", 50).asUInt64() * 1000;
+        result.intervalMicros = c.get("interval_ms", 100).asInt64() * 1000;
+        result.maxInflight[AdmissionController::LOW] = limits.get("low", 10).asInt64();
+        result.maxInflight[AdmissionController::NORMAL] = limits.get("normal", 30).asInt64();
+        result.maxInflight[AdmissionController::HIGH] = limits.get("high", 100).asInt64();
+        result.retryAfterSeconds = c.get("retry_after_seconds", 1).asInt();
+        return result;
+    }();
+    return cfg;
+}
+
+const uint64_t NO_SAMPLE = std::numeric_limits<uint64_t>::max();
+
+std::atomic<int64_t> inFlight{0};
+
+// CoDel状态：当前间隔内的最小查询耗时，间隔结束时据此判断是否过载
+std::atomic<uint64_t> intervalMinMicros{NO_SAMPLE};
+std::atomic<int64_t> intervalEnd{0};
+std::atomic<bool> overloadedFlag{false};
+
+std::array<std::atomic<uint64_t>, AdmissionController::PRIORITY_COUNT> shed{};
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ * 间隔结束时更新过载判断（由第一个发现间隔已结束的线程执行）
+ */
+void evaluate() {
+    int64_t now = nowMicros();
+    int64_t end = intervalEnd.load(std::memory_order_relaxed);
+    if (now < end) {
+        return;
+    }
+    if (!intervalEnd.compare_exchange_strong(end, now + config().intervalMicros)) {
+        return;
+    }
+
+    uint64_t minMicros = intervalMinMicros.exchange(NO_SAMPLE, std::memory_order_relaxed);
+    bool overloaded;
+    if (minMicros == NO_SAMPLE) {
+        // 整个间隔内没有查询完成：有查询在途说明卡住了
+        overloaded = inFlight.load(std::memory_order_relaxed) > 0 && end != 0;
+    } else {
+        overloaded = minMicros > config().targetMicros;
+    }
+
+    if (overloaded != overloadedFlag.load(std::memory_order_relaxed)) {
+        overloadedFlag.store(overloaded, std::memory_order_relaxed);
+        if (overloaded) {
+            LOG_WARN << "Admission control: database overloaded (min latency "
+                     << (minMicros == NO_SAMPLE ? -1 : static_cast<int64_t>(minMicros / 1000))
+                     << "ms, " << inFlight.load() << " queries in flight), shedding low priority requests";
+        } else {
+            LOG_INFO << "Admission control: database load back to normal";
+        }
+    }
+}
+
+} // namespace
+
+AdmissionController::Priority AdmissionController::classify(const drogon::HttpRequestPtr& req) {
+    const auto& path = req->path();
+    // 只有Token有效才算已登录（只带 Authorization 头不能提升优先级），
+    // 验证结果缓存在请求上，AuthFilter 不会重复验证
+    bool authenticated = !req->getHeader("Authorization").empty() && JwtUtil::verifyRequest(req);
+
+    // 内存缓存读，几乎不占用数据库
+    if (path == "/api/like/status" || path == "/metrics") {
+        return HIGH;
+    }
+    // 已登录用户的写操作
+    if (authenticated && req->method() != drogon::Get) {
+        return HIGH;
+    }
+    if (authenticated || path == "/api/user/login" || path == "/api/user/register") {
+        return NORMAL;
+    }
+    // 匿名读（列表/详情抓取）
+    return LOW;
+}
+
+drogon::HttpResponsePtr AdmissionController::admit(const drogon::HttpRequestPtr& req) {
+    const auto& cfg = config();
+    if (!cfg.enabled) {
+        return nullptr;
+    }
+
+    evaluate();
+
+    auto priority = classify(req);
+    bool reject = inFlight.load(std::memory_order_relaxed) >= cfg.maxInflight[priority];
+    // 持续积压时低优先级请求全部拒绝
+    if (!reject && priority == LOW && overloadedFlag.load(std::memory_order_relaxed)) {
+        reject = true;
+    }
+    if (!reject) {
+        return nullptr;
+    }
+
+    shed[priority].fetch_add(1, std::memory_order_relaxed);
+
+    auto resp = ResponseUtil::error(ResponseUtil::SERVER_BUSY, "服务繁忙，请稍后再试");
+    resp->setStatusCode(drogon::k503ServiceUnavailable);
+    resp->addHeader("Retry-After", std::to_string(cfg.retryAfterSeconds));
+    return resp;
+}
+
+void AdmissionController::queryStarted() {
+    inFlight.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AdmissionController::queryFinished(uint64_t micros) {
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+    uint64_t current = intervalMinMicros.load(std::memory_order_relaxed);
+    while (micros < current &&
+           !intervalMinMicros.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+
+    evaluate();
+}
+
+int64_t AdmissionController::queriesInFlight() {
+    return inFlight.load(std::memory_order_relaxed);
+}
+
+bool AdmissionController::overloaded() {
+    return overloadedFlag.load(std::memory_order_relaxed);
+}
+
+uint64_t AdmissionController::shedCount(Priority priority) {
+    return shed[priority].load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <cstdint>
+
+/**
+ * 准入控制（过载保护）
+ *
+ * 数据库连接池很小（默认5个连接），过载时查询在池中排队，直到10秒超时才失败，
+ * 所有请求都会"慢慢地失败"。准入控制在路由前根据数据库负载提前拒绝一部分请求，
+ * 直接返回503和Retry-After，让被接受的请求仍能快速完成
+ *
+ * 负载信号：
+ * 1. 进行中的数据库查询数（执行中+排队中）
+ * 2. CoDel式延迟判断：一个时间间隔（interval）内所有查询的最小耗时都超过目标值（target），
+ *    说明队列持续积压而不是瞬时突发，判定为过载
+ *
+ * 请求按优先级分级，负载升高时从低优先级开始拒绝（"已登录"指携带有效Token）：
+ * - HIGH:   内存缓存读（点赞状态、指标）、已登录用户的写操作
+ * - NORMAL: 已登录用户的读、登录/注册
+ * - LOW:    匿名读（帖子列表/详情，主要是抓取流量）
+ *
+ * 配置（custom_config.admission_control）：
+ * - enabled: 是否启用
+ * - target_ms / interval_ms: CoDel目标延迟和判断间隔
+ * - max_inflight_queries: {low, normal, high} 各优先级允许的进行中查询数上限
+ * - retry_after_seconds: 503响应的Retry-After
+ */
+class AdmissionController {
+public:
+    enum Priority {
+        LOW = 0,
+        NORMAL = 1,
+        HIGH = 2,
+        PRIORITY_COUNT = 3
+    };
+
+    /**
+     * 判断是否接受请求
+     * @return nullptr=接受；否则为应直接返回的503响应
+     */
+    static drogon::HttpResponsePtr admit(const drogon::HttpRequestPtr& req);
+
+    /**
+     * 请求优先级
+     */
+    static Priority classify(const drogon::HttpRequestPtr& req);
+
+    /**
+     * 数据库查询开始/结束（由 sql::execAsync 调用）
+     */
+    static void queryStarted();
+    static void queryFinished(uint64_t micros);
+
+    /**
+     * 当前进行中的数据库查询数
+     */
+    static int64_t queriesInFlight();
+
+    /**
+     * 当前是否判定为过载
+     */
+    static bool overloaded();
+
+    /**
+     * 某个优先级被拒绝的请求数
+     */
+    static uint64_t shedCount(Priority priority);
+};
@@ -1,65 +1,207 @@
 #include "ErrorLogger.h"
+#include <trantor/net/EventLoopThread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <unistd.h>
 
-// 初始化静态成员
-std::mt19937 ErrorLogger::rng_(std::chrono::steady_clock::now().time_since_epoch().count());
-std::uniform_int_distribution<int> ErrorLogger::dist_(0, 65535);
+namespace {
 
-std::string ErrorLogger::generateErrorId() {
+struct RateLimitConfig {
+    double ratePerSecond;
+    double burst;
+};
+
+const RateLimitConfig& rateLimitConfig() {
+    static const RateLimitConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["error_log"];
+        RateLimitConfig result;
+        result.ratePerSecond = std::max(0.0, c.get("rate_per_second", 100).asDouble());
+        result.burst = std::max(1.0, c.get("burst", 200).asDouble());
+        return result;
+    }();
+    return cfg;
+}
+
+// 线程序号分配
+std::atomic<uint32_t> nextThreadIndex{0};
+
+/**
+ * 每个线程独立的状态（只由所属线程访问，无需同步）
+ */
+struct ThreadState {
+    uint32_t index = nextThreadIndex.fetch_add(1, std::memory_order_relaxed) & 0xFF;
+    uint32_t counter = 0;
+
+    // 令牌桶
+    bool bucketInitialized = false;
+    double tokens = 0;
+    std::chrono::steady_clock::time_point lastRefill;
+    uint64_t suppressed = 0;
+};
+
+ThreadState& threadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+char* appendDecimal(char* p, uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+char* appendHex(char* p, uint64_t value, int width) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (int i = width - 1; i >= 0; i--) {
+        *p++ = hex[(value >> (i * 4)) & 0xF];
+    }
+    return p;
+}
+
+/**
+ * 写日志线程（首次使用时启动）
+ */
+trantor::EventLoop* writerLoop() {
+    static trantor::EventLoopThread* thread = [] {
+        auto* t = new trantor::EventLoopThread("ErrorLogWriter");
+        t->run();
+        return t;
+    }();
+    return thread->getLoop();
+}
+
+} // namespace
+
+ErrorId ErrorLogger::generateErrorId() {
     // 获取当前时间戳（秒）
-    auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
-        now.time_since_epoch()
+        std::chrono::system_clock::now().time_since_epoch()
     ).count();
 
-    // 生成随机十六进制后缀
-    std::string randomHex = generateRandomHex();
+    // 进程号：多进程部署时各进程的线程序号和计数会重复
+    static const uint32_t processId = static_cast<uint32_t>(getpid()) & 0xFFFFFF;
 
-    // 组合成错误ID: ERR-{timestamp}-{random}
-    std::ostringstream oss;
-    oss << "ERR-" << timestamp << "-" << randomHex;
+    auto& state = threadState();
+    uint32_t sequence = ++state.counter & 0xFFFFFF;
 
-    return oss.str();
+    // 组合成错误ID: ERR-{timestamp}-{进程号}-{线程序号}{计数}
+    ErrorId id;
+    char* p = id.buf_;
+    *p++ = 'E';
+    *p++ = 'R';
+    *p++ = 'R';
+    *p++ = '-';
+    p = appendDecimal(p, static_cast<uint64_t>(timestamp));
+    *p++ = '-';
+    p = appendHex(p, processId, 6);
+    *p++ = '-';
+    p = appendHex(p, state.index, 2);
+    p = appendHex(p, sequence, 6);
+    *p = '\0';
+    id.len_ = static_cast<size_t>(p - id.buf_);
+    return id;
 }
 
-std::string ErrorLogger::generateRandomHex() {
-    int randomNum = dist_(rng_);
-    std::ostringstream oss;
-    oss << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << randomNum;
-    return oss.str();
+void ErrorLogger::emit(std::string&& line) {
+    auto& state = threadState();
+    const auto& cfg = rateLimitConfig();
+    auto now = std::chrono::steady_clock::now();
+
+    // 令牌桶限速
+    if (!state.bucketInitialized) {
+        state.bucketInitialized = true;
+        state.tokens = cfg.burst;
+        state.lastRefill = now;
+    } else {
+        double elapsed = std::chrono::duration<double>(now - state.lastRefill).count();
+        state.tokens = std::min(cfg.burst, state.tokens + elapsed * cfg.ratePerSecond);
+        state.lastRefill = now;
+    }
+
+    if (state.tokens < 1.0) {
+        state.suppressed++;
+        return;
+    }
+    state.tokens -= 1.0;
+
+    uint64_t suppressed = state.suppressed;
+    state.suppressed = 0;
+
+    writerLoop()->queueInLoop([line = std::move(line), suppressed]() {
+        if (suppressed > 0) {
+            LOG_ERROR << suppressed << " error log lines suppressed by rate limit";
+        }
+        LOG_ERROR << line;
+    });
 }
 
 void ErrorLogger::logDatabaseError(
-    const std::string& errorId,
+    const ErrorId& errorId,
     const std::string& operation,
     const drogon::orm::DrogonDbException& exception,
     bool includeDetails
 ) {
+    std::string line;
+    line.reserve(96);
+    line += '[';
+    line.append(errorId.c_str(), errorId.size());
+    line += "] Database error during ";
+    line += operation;
+
     if (includeDetails || shouldIncludeDetails()) {
         // 开发环境：记录详细信息
-        LOG_ERROR << "[" << errorId << "] Database error during " << operation
-                  << " - Details: " << exception.base().what();
+        line += " - Details: ";
+        line += exception.base().what();
     } else {
         // 生产环境：只记录操作和错误ID，不记录详细信息
-        LOG_ERROR << "[" << errorId << "] Database error during " << operation
-                  << " (Use error ID for tracking)";
+        line += " (Use error ID for tracking)";
     }
+    emit(std::move(line));
+}
+
+void ErrorLogger::logBackgroundError(
+    const std::string& operation,
+    const drogon::orm::DrogonDbException& exception
+) {
+    std::string line;
+    line.reserve(96);
+    line += "Database error during ";
+    line += operation;
+    line += ": ";
+    line += exception.base().what();
+    emit(std::move(line));
 }
 
 void ErrorLogger::logError(
-    const std::string& errorId,
+    const ErrorId& errorId,
     const std::string& operation,
     const std::string& errorMessage,
     bool includeDetails
 ) {
+    std::string line;
+    line.reserve(96);
+    line += '[';
+    line.append(errorId.c_str(), errorId.size());
+    line += "] Error during ";
+    line += operation;
+
     if (includeDetails || shouldIncludeDetails()) {
         // 开发环境：记录详细信息
-        LOG_ERROR << "[" << errorId << "] Error during " << operation
-                  << " - Details: " << errorMessage;
+        line += " - Details: ";
+        line += errorMessage;
     } else {
         // 生产环境：只记录操作和错误ID
-        LOG_ERROR << "[" << errorId << "] Error during " << operation
-                  << " (Use error ID for tracking)";
+        line += " (Use error ID for tracking)";
     }
+    emit(std::move(line));
 }
 
 bool ErrorLogger::shouldIncludeDetails() {
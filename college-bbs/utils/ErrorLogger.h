@@ -1,13 +1,32 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <sstream>
-#include <iomanip>
-#include <chrono>
-#include <random>
 #include <drogon/HttpResponse.h>
 #include <drogon/drogon.h>
 
+/**
+ * 错误ID
+ *
+ * 定长缓冲区，生成时不分配内存；需要字符串时可隐式转换为 std::string
+ */
+class ErrorId {
+public:
+    static const size_t MAX_LENGTH = 31;
+
+    const char* c_str() const { return buf_; }
+    size_t size() const { return len_; }
+
+    operator std::string() const { return std::string(buf_, len_); }
+
+private:
+    friend class ErrorLogger;
+
+    char buf_[MAX_LENGTH + 1] = {};
+    size_t len_ = 0;
+};
+
 /**
  * 错误日志工具类
  *
@@ -18,15 +37,27 @@
  * 2. 详细的错误信息只记录到日志文件（ERROR级别）
  * 3. 返回给用户的只包含通用错误消息和错误ID
  * 4. 在开发环境可以选择包含详细信息，生产环境则隐藏
+ *
+ * 数据库故障时每个请求都会走到这里，因此：
+ * - 错误ID由进程号、线程序号和线程内计数生成，无锁、无内存分配（多进程部署时各进程的ID不会重复）
+ * - 日志按线程限速（令牌桶），超出的只计数，恢复后汇总输出一行
+ * - 日志行交给独立的写日志线程输出，不阻塞IO线程
+ *
+ * 控制器和后台任务（浏览数写回、回复合并写入、帖子清除）的数据库错误都经这里输出，
+ * 数据库故障期间不会因为错误日志把日志输出压垮
+ *
+ * 配置（custom_config.error_log）：
+ * - rate_per_second: 每个线程每秒最多输出的错误日志数
+ * - burst: 允许的突发条数
  */
 class ErrorLogger {
 public:
     /**
      * 生成唯一的错误ID
-     * 格式: ERR-{timestamp}-{random}
-     * 示例: ERR-1700000000-A3F2
+     * 格式: ERR-{timestamp}-{进程号6位十六进制}-{线程序号2位十六进制}{线程内计数6位十六进制}
+     * 示例: ERR-1700000000-00A1B2-0300A3F2
      */
-    static std::string generateErrorId();
+    static ErrorId generateErrorId();
 
     /**
      * 记录数据库错误
@@ -37,12 +68,24 @@ public:
      * @param includeDetails 是否在日志中包含详细信息（默认false，生产环境应为false）
      */
     static void logDatabaseError(
-        const std::string& errorId,
+        const ErrorId& errorId,
         const std::string& operation,
         const drogon::orm::DrogonDbException& exception,
         bool includeDetails = false
     );
 
+    /**
+     * 记录后台任务的数据库错误（没有对应的请求，不生成错误ID）
+     * 后台任务的错误没有别处可查，总是记录详细信息
+     *
+     * @param operation 操作描述（如"flush view count"）
+     * @param exception 数据库异常对象
+     */
+    static void logBackgroundError(
+        const std::string& operation,
+        const drogon::orm::DrogonDbException& exception
+    );
+
     /**
      * 记录一般错误
      *
@@ -52,7 +95,7 @@ public:
      * @param includeDetails 是否在日志中包含详细信息
      */
     static void logError(
-        const std::string& errorId,
+        const ErrorId& errorId,
         const std::string& operation,
         const std::string& errorMessage,
         bool includeDetails = false
@@ -67,11 +110,8 @@ public:
     static bool shouldIncludeDetails();
 
 private:
-    static std::mt19937 rng_;
-    static std::uniform_int_distribution<int> dist_;
-
     /**
-     * 生成4位随机十六进制字符串
+     * 限速后交给写日志线程输出
      */
-    static std::string generateRandomHex();
+    static void emit(std::string&& line);
 };
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "RequestContext.h"
+#include <drogon/HttpResponse.h>
+#include <functional>
+#include <memory>
+#include <utility>
+
+/**
+ * 请求处理状态
+ *
+ * 控制器的异步回调链每一层都按值捕获 callback 和请求参数（标题、内容等），
+ * 每层闭包都复制一遍；std::function 捕获的对象超过其内部缓冲区时还要额外分配。
+ *
+ * 改为在处理开始时把 callback、请求上下文和参数一次性移入一份共享状态，
+ * 各层闭包只捕获一个 shared_ptr（不复制参数，闭包小到可以放进 std::function 内部缓冲区）。
+ * 参数在最后一次使用时可以直接移走，例如把回复内容移交给写入合并器
+ *
+ * 用法：
+ *   struct CreateData { int user_id; std::string content; };
+ *   auto state = makeHandlerState(std::move(callback), ctx, CreateData{user_id, std::move(content)});
+ *   sql::execAsync(state->ctx, dbClient, stmt,
+ *                  [state](const Result& r) { state->respond(ResponseUtil::success()); }, ...);
+ */
+template <typename Data>
+class HandlerState {
+public:
+    using Callback = std::function<void(const drogon::HttpResponsePtr&)>;
+
+    // 请求上下文
+    const RequestContextPtr ctx;
+
+    // 处理器自己的参数
+    Data data;
+
+    HandlerState(Callback&& callback, RequestContextPtr context, Data&& handlerData)
+        : ctx(std::move(context)), data(std::move(handlerData)), callback_(std::move(callback)) {}
+
+    HandlerState(const HandlerState&) = delete;
+    HandlerState& operator=(const HandlerState&) = delete;
+
+    /**
+     * 返回响应（只有第一次调用生效，之后 callback 已被移走）
+     */
+    void respond(const drogon::HttpResponsePtr& resp) {
+        if (!callback_) {
+            return;
+        }
+        auto callback = std::move(callback_);
+        callback_ = nullptr;
+        callback(resp);
+    }
+
+private:
+    Callback callback_;
+};
+
+template <typename Data>
+using HandlerStatePtr = std::shared_ptr<HandlerState<Data>>;
+
+// 不需要额外参数的处理器
+struct NoHandlerData {};
+
+/**
+ * 创建处理状态（callback 和参数都被移入，不复制）
+ */
+template <typename Data>
+HandlerStatePtr<Data> makeHandlerState(std::function<void(const drogon::HttpResponsePtr&)>&& callback,
+                                       RequestContextPtr ctx, Data&& data) {
+    return std::make_shared<HandlerState<Data>>(std::move(callback), std::move(ctx), std::move(data));
+}
+
+/**
+ * 创建只含 callback 和请求上下文的处理状态
+ */
+inline HandlerStatePtr<NoHandlerData> makeHandlerState(
+    std::function<void(const drogon::HttpResponsePtr&)>&& callback, RequestContextPtr ctx) {
+    return makeHandlerState(std::move(callback), std::move(ctx), NoHandlerData{});
+}
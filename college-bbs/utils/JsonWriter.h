@@ -0,0 +1,125 @@
+#pragma once
+
+#include "RowMapper.h"
+#include <json/writer.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * 结构体直接序列化为JSON文本（编译期字段描述）
+ *
+ * 手写的 post["id"] = row["id"].as<int>() 每个字段都要按名字查找列、插入一次DOM节点，
+ * 最后再把整棵 Json::Value 序列化一遍。结构体声明一次字段列表（JSON键名 + 成员指针），
+ * json::appendObject() 按列表展开成逐字段的拼接代码，不经过 Json::Value：
+ *   static constexpr auto jsonFields() {
+ *       return std::make_tuple(json::field("content", &ReplyRow::content),
+ *                              json::field("id", &ReplyRow::id));
+ *   }
+ *
+ * 字段按键名的字母顺序声明，输出与 Json::Value 的序列化结果一致（键有序、无空白、
+ * 字符串转义相同），与其他接口和已缓存的片段格式相同
+ */
+namespace json {
+
+template <typename Struct, typename T>
+struct Field {
+    const char* name;
+    T Struct::*member;
+};
+
+template <typename Struct, typename T>
+constexpr Field<Struct, T> field(const char* name, T Struct::*member) {
+    return Field<Struct, T>{name, member};
+}
+
+/**
+ * 已经序列化好的JSON片段，原样写入
+ */
+struct Raw {
+    std::string text;
+};
+
+inline void appendValue(std::string& out, int value) {
+    out += std::to_string(value);
+}
+
+inline void appendValue(std::string& out, const std::string& value) {
+    out += Json::valueToQuotedString(value.c_str());
+}
+
+inline void appendValue(std::string& out, const Raw& value) {
+    out += value.text;
+}
+
+template <typename T>
+void appendValue(std::string& out, const std::vector<T>& values);
+
+template <typename T, typename = decltype(T::jsonFields())>
+void appendValue(std::string& out, const T& value);
+
+/**
+ * 按字段列表序列化一个对象
+ */
+template <typename T>
+void appendObject(std::string& out, const T& value) {
+    out += '{';
+    bool first = true;
+    std::apply(
+        [&](const auto&... fields) {
+            ((out += first ? "\"" : ",\"",
+              first = false,
+              out += fields.name,
+              out += "\":",
+              appendValue(out, value.*(fields.member))), ...);
+        },
+        T::jsonFields());
+    out += '}';
+}
+
+template <typename T>
+void appendValue(std::string& out, const std::vector<T>& values) {
+    out += '[';
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendValue(out, values[i]);
+    }
+    out += ']';
+}
+
+template <typename T, typename>
+void appendValue(std::string& out, const T& value) {
+    appendObject(out, value);
+}
+
+/**
+ * 查询结果直接序列化为JSON数组：按列位置解码（行类型的 COLUMNS / decode），
+ * 按 jsonFields() 输出，不保留中间结果
+ */
+template <typename Row>
+void appendRows(std::string& out, const drogon::orm::Result& r) {
+    out += '[';
+    bool first = true;
+    sql::forEachRow<Row>(r, [&](Row&& row) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        appendObject(out, row);
+    });
+    out += ']';
+}
+
+/**
+ * 序列化一个对象并返回
+ */
+template <typename T>
+std::string toJson(const T& value) {
+    std::string out;
+    appendObject(out, value);
+    return out;
+}
+
+} // namespace json
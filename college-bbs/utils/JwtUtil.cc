@@ -1,6 +1,7 @@
 #include "JwtUtil.h"
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <vector>
@@ -12,6 +13,9 @@ const std::string JwtUtil::SECRET_KEY = "college_bbs_secret_key_2024";
 // Token有效期：7天 = 7 * 24 * 60 * 60秒
 const int JwtUtil::EXPIRATION_TIME = 7 * 24 * 60 * 60;
 
+// attributes 中缓存验证结果的键
+static const std::string AUTH_RESULT_KEY = "jwt_verified";
+
 // Base64字符表
 static const std::string base64_chars =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -155,6 +159,10 @@ std::string JwtUtil::hmacSha256(const std::string& key, const std::string& data)
 }
 
 std::string JwtUtil::generateToken(int user_id, const std::string& username) {
+    return generateToken(user_id, username, EXPIRATION_TIME);
+}
+
+std::string JwtUtil::generateToken(int user_id, const std::string& username, int64_t expires_in) {
     // 1. 创建Header
     Json::Value header;
     header["alg"] = "HS256";
@@ -172,7 +180,7 @@ std::string JwtUtil::generateToken(int user_id, const std::string& username) {
 
     // 设置过期时间
     auto now = std::chrono::system_clock::now();
-    auto exp = std::chrono::system_clock::to_time_t(now) + EXPIRATION_TIME;
+    auto exp = std::chrono::system_clock::to_time_t(now) + expires_in;
     payload["exp"] = static_cast<Json::Int64>(exp);
 
     // 签发时间
@@ -250,3 +258,29 @@ bool JwtUtil::verifyToken(const std::string& token, int& user_id, std::string& u
         return false;
     }
 }
+
+bool JwtUtil::verifyRequest(const drogon::HttpRequestPtr& req) {
+    auto attributes = req->attributes();
+    if (attributes->find(AUTH_RESULT_KEY)) {
+        return attributes->get<bool>(AUTH_RESULT_KEY);
+    }
+
+    // Token格式: Bearer <token>
+    const std::string& authHeader = req->getHeader("Authorization");
+    std::string token;
+    if (authHeader.length() >= 7 && authHeader.compare(0, 7, "Bearer ") == 0) {
+        token = authHeader.substr(7);
+    } else {
+        token = authHeader;
+    }
+
+    int user_id;
+    std::string username;
+    bool valid = !token.empty() && verifyToken(token, user_id, username);
+    if (valid) {
+        attributes->insert("user_id", user_id);
+        attributes->insert("username", username);
+    }
+    attributes->insert(AUTH_RESULT_KEY, valid);
+    return valid;
+}
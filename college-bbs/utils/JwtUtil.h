@@ -2,7 +2,9 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <json/json.h>
+#include <drogon/HttpRequest.h>
 
 /**
  * JWT工具类
@@ -18,6 +20,12 @@ public:
      */
     static std::string generateToken(int user_id, const std::string& username);
 
+    /**
+     * 生成指定有效期的JWT Token
+     * @param expires_in 有效期（秒），为负数时生成已过期的Token
+     */
+    static std::string generateToken(int user_id, const std::string& username, int64_t expires_in);
+
     /**
      * 验证JWT Token
      * @param token JWT Token字符串
@@ -27,6 +35,14 @@ public:
      */
     static bool verifyToken(const std::string& token, int& user_id, std::string& username);
 
+    /**
+     * 验证请求携带的Token（Authorization: Bearer <token>）
+     * 结果缓存在请求的attributes中：准入控制在路由前据此分级，AuthFilter随后鉴权，
+     * 同一请求只验证一次签名。成功时把 user_id、username 写入attributes
+     * @return true=Token有效
+     */
+    static bool verifyRequest(const drogon::HttpRequestPtr& req);
+
 private:
     // JWT密钥，建议从环境变量或配置文件读取
     static const std::string SECRET_KEY;
@@ -0,0 +1,88 @@
+#include "LatencyHistogram.h"
+
+const int LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t LatencyHistogram::LINEAR_LIMIT;
+const int LatencyHistogram::MAX_EXPONENT;
+const size_t LatencyHistogram::BUCKET_COUNT;
+
+size_t LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < LINEAR_LIMIT) {
+        return static_cast<size_t>(micros);
+    }
+
+    // 最高位所在的数量级（micros >= 16 时 exponent >= 4）
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    // 取最高位之后的 SUB_BUCKET_BITS 位作为子桶
+    size_t sub = (micros >> (exponent - SUB_BUCKET_BITS)) & ((size_t(1) << SUB_BUCKET_BITS) - 1);
+    return LINEAR_LIMIT + static_cast<size_t>(exponent - 4) * (size_t(1) << SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < LINEAR_LIMIT) {
+        return index;
+    }
+
+    size_t offset = index - LINEAR_LIMIT;
+    int exponent = static_cast<int>(offset >> SUB_BUCKET_BITS) + 4;
+    uint64_t sub = offset & ((size_t(1) << SUB_BUCKET_BITS) - 1);
+    uint64_t width = uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    return (uint64_t(1) << exponent) + (sub + 1) * width - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    counts_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    sumMicros_.fetch_add(micros, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snap;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        snap.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        snap.total += snap.counts[i];
+    }
+    snap.sumMicros = sumMicros_.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sumMicros += other.sumMicros;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double quantile) const {
+    if (total == 0) {
+        return 0;
+    }
+
+    // 第rank个样本所在的桶
+    uint64_t rank = static_cast<uint64_t>(quantile * total);
+    if (rank >= total) {
+        rank = total - 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen > rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyHistogram::Snapshot::countAtOrBelow(uint64_t micros) const {
+    // 只累计上界不超过 micros 的桶：micros 所在的桶里可能有大于 micros 的样本，
+    // 计入会让Prometheus的 le 桶偏大
+    uint64_t result = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= micros; i++) {
+        result += counts[i];
+    }
+    return result;
+}
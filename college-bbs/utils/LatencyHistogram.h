@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 延迟直方图（HDR风格，对数-线性分桶）
+ *
+ * 以微秒为单位记录延迟：
+ * - 0-15us 每微秒一个桶
+ * - 之后每个2的幂区间再均分为8个子桶，相对误差不超过12.5%
+ *
+ * 桶计数为原子变量，record() 无锁，可被多个线程同时调用
+ */
+class LatencyHistogram {
+public:
+    // 每个2的幂区间的子桶位数（2^3 = 8个子桶）
+    static const int SUB_BUCKET_BITS = 3;
+    // 线性区间上限（小于该值的延迟每微秒一个桶）
+    static const uint64_t LINEAR_LIMIT = 16;
+    // 最大可记录的数量级（2^36us ≈ 19小时，更大的值记入最后一个桶）
+    static const int MAX_EXPONENT = 36;
+    // 桶数量
+    static const size_t BUCKET_COUNT =
+        LINEAR_LIMIT + (MAX_EXPONENT - 4 + 1) * (size_t(1) << SUB_BUCKET_BITS);
+
+    /**
+     * 直方图快照（非原子，可合并、可计算分位数）
+     */
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> counts{};
+        uint64_t total = 0;
+        uint64_t sumMicros = 0;
+
+        /**
+         * 合并另一个快照
+         */
+        void merge(const Snapshot& other);
+
+        /**
+         * 计算分位数（返回桶上界，单位微秒）
+         * @param quantile 0.0-1.0，如0.99
+         */
+        uint64_t percentile(double quantile) const;
+
+        /**
+         * 小于等于某个值（微秒）的样本数
+         * 按桶统计，只计入上界不超过该值的桶（结果可能偏小，不会偏大）
+         */
+        uint64_t countAtOrBelow(uint64_t micros) const;
+    };
+
+    /**
+     * 记录一个延迟样本
+     */
+    void record(uint64_t micros);
+
+    /**
+     * 获取快照
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * 计算某个延迟值所在的桶
+     */
+    static size_t bucketIndex(uint64_t micros);
+
+    /**
+     * 桶的上界（包含，单位微秒）
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_{};
+    std::atomic<uint64_t> sumMicros_{0};
+};
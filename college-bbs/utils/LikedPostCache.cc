@@ -0,0 +1,254 @@
+#include "LikedPostCache.h"
+#include "RedisCache.h"
+#include "SqlStatements.h"
+#include "../models/LikeRows.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace drogon::orm;
+
+namespace {
+
+// 分片数量
+const size_t SHARD_COUNT = 16;
+
+// 失效消息频道：消息为 "<发布进程pid> <user_id>"
+const char* const INVALIDATE_CHANNEL = "like:invalidate";
+
+struct Entry {
+    int user_id;
+    std::unique_ptr<RoaringBitmap> bitmap;
+    std::chrono::steady_clock::time_point loadedAt;
+};
+
+// 正在加载中的用户状态
+struct LoadState {
+    int pending = 0;     // 进行中的加载请求数
+    bool dirty = false;  // 加载期间发生过修改，结果不可信
+};
+
+struct Shard {
+    std::mutex mutex;
+    std::list<Entry> lru;  // 头部为最近访问
+    std::unordered_map<int, std::list<Entry>::iterator> index;
+    std::unordered_map<int, LoadState> loading;
+};
+
+Shard& shardFor(int user_id) {
+    static Shard shards[SHARD_COUNT];
+    return shards[static_cast<unsigned int>(user_id) % SHARD_COUNT];
+}
+
+} // namespace
+
+size_t LikedPostCache::shardCapacity() {
+    static const size_t capacity = [] {
+        const auto& config = drogon::app().getCustomConfig()["liked_post_cache"];
+        size_t maxUsers = config.get("max_users", 10000).asUInt64();
+        return std::max<size_t>(1, maxUsers / SHARD_COUNT);
+    }();
+    return capacity;
+}
+
+std::chrono::steady_clock::duration LikedPostCache::maxAge() {
+    static const auto maxAge = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(
+            drogon::app().getCustomConfig()["liked_post_cache"].get("max_age_seconds", 60).asDouble()));
+    return maxAge;
+}
+
+void LikedPostCache::start() {
+    // 本进程发布的消息也会收到，按pid跳过
+    static const pid_t self = ::getpid();
+    RedisCache::subscribe(INVALIDATE_CHANNEL, [](const std::string& message) {
+        char* end = nullptr;
+        long pid = std::strtol(message.c_str(), &end, 10);
+        if (pid == self || *end != ' ') {
+            return;
+        }
+        invalidate(std::atoi(end + 1));
+    });
+}
+
+bool LikedPostCache::visit(int user_id, const std::function<void(const RoaringBitmap&)>& visitor) {
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(user_id);
+    if (it == shard.index.end()) {
+        return false;
+    }
+
+    // 过期条目按未命中处理，重新加载时覆盖
+    if (std::chrono::steady_clock::now() - it->second->loadedAt > maxAge()) {
+        return false;
+    }
+
+    // 移到LRU头部
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    visitor(*it->second->bitmap);
+    return true;
+}
+
+void LikedPostCache::load(const RequestContextPtr& ctx, int user_id,
+                          std::function<void(const RoaringBitmap&)>&& onLoaded,
+                          ErrorCallback&& errorCallback) {
+    auto& shard = shardFor(user_id);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.loading[user_id].pending++;
+    }
+
+    auto dbClient = drogon::app().getDbClient();
+    sql::execAsync(
+        ctx, dbClient, sql::LIKE_POSTS_BY_USER,
+        [user_id, onLoaded = std::move(onLoaded)](const Result& r) {
+            auto bitmap = std::make_unique<RoaringBitmap>();
+            sql::forEachRow<models::LikedPostRow>(r, [&bitmap](models::LikedPostRow&& row) {
+                bitmap->add(static_cast<uint32_t>(row.post_id));
+            });
+
+            // 先用本次加载的结果回答调用方，再放入缓存
+            onLoaded(*bitmap);
+
+            auto& shard = shardFor(user_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            auto& state = shard.loading[user_id];
+            bool dirty = state.dirty;
+            if (--state.pending <= 0) {
+                shard.loading.erase(user_id);
+            }
+
+            // 加载期间被修改过，丢弃结果，下次访问重新加载
+            if (dirty) {
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            auto it = shard.index.find(user_id);
+            if (it != shard.index.end()) {
+                it->second->bitmap = std::move(bitmap);
+                it->second->loadedAt = now;
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                return;
+            }
+
+            shard.lru.push_front(Entry{user_id, std::move(bitmap), now});
+            shard.index[user_id] = shard.lru.begin();
+
+            // LRU淘汰
+            while (shard.index.size() > shardCapacity()) {
+                shard.index.erase(shard.lru.back().user_id);
+                shard.lru.pop_back();
+            }
+        },
+        [user_id, errorCallback = std::move(errorCallback)](const DrogonDbException& e) {
+            {
+                auto& shard = shardFor(user_id);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.loading.find(user_id);
+                if (it != shard.loading.end() && --it->second.pending <= 0) {
+                    shard.loading.erase(it);
+                }
+            }
+            errorCallback(e);
+        },
+        user_id
+    );
+}
+
+void LikedPostCache::isLiked(const RequestContextPtr& ctx, int user_id, int post_id,
+                             LikedCallback&& callback,
+                             ErrorCallback&& errorCallback) {
+    bool liked = false;
+    bool hit = visit(user_id, [&liked, post_id](const RoaringBitmap& bitmap) {
+        liked = bitmap.contains(static_cast<uint32_t>(post_id));
+    });
+
+    if (hit) {
+        callback(liked);
+        return;
+    }
+
+    load(ctx, user_id,
+         [post_id, callback = std::move(callback)](const RoaringBitmap& bitmap) {
+             callback(bitmap.contains(static_cast<uint32_t>(post_id)));
+         },
+         std::move(errorCallback));
+}
+
+void LikedPostCache::getLikedPostIds(const RequestContextPtr& ctx, int user_id, std::vector<int> post_ids,
+                                     LikedListCallback&& callback,
+                                     ErrorCallback&& errorCallback) {
+    auto filter = [](const RoaringBitmap& bitmap, const std::vector<int>& ids) {
+        std::vector<int> liked;
+        for (int id : ids) {
+            if (bitmap.contains(static_cast<uint32_t>(id))) {
+                liked.push_back(id);
+            }
+        }
+        return liked;
+    };
+
+    std::vector<int> liked;
+    bool hit = visit(user_id, [&](const RoaringBitmap& bitmap) {
+        liked = filter(bitmap, post_ids);
+    });
+
+    if (hit) {
+        callback(liked);
+        return;
+    }
+
+    load(ctx, user_id,
+         [filter, post_ids = std::move(post_ids), callback = std::move(callback)](const RoaringBitmap& bitmap) {
+             callback(filter(bitmap, post_ids));
+         },
+         std::move(errorCallback));
+}
+
+void LikedPostCache::update(int user_id, int post_id, bool liked) {
+    RedisCache::publish(INVALIDATE_CHANNEL, std::to_string(::getpid()) + " " + std::to_string(user_id));
+
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto loadingIt = shard.loading.find(user_id);
+    if (loadingIt != shard.loading.end()) {
+        loadingIt->second.dirty = true;
+    }
+
+    auto it = shard.index.find(user_id);
+    if (it == shard.index.end()) {
+        return;
+    }
+
+    if (liked) {
+        it->second->bitmap->add(static_cast<uint32_t>(post_id));
+    } else {
+        it->second->bitmap->remove(static_cast<uint32_t>(post_id));
+    }
+}
+
+void LikedPostCache::invalidate(int user_id) {
+    auto& shard = shardFor(user_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto loadingIt = shard.loading.find(user_id);
+    if (loadingIt != shard.loading.end()) {
+        loadingIt->second.dirty = true;
+    }
+
+    auto it = shard.index.find(user_id);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+}
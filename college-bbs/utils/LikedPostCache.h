@@ -0,0 +1,88 @@
+#pragma once
+
+#include "RequestContext.h"
+#include "RoaringBitmap.h"
+#include <drogon/orm/DbClient.h>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+/**
+ * 用户点赞集合缓存
+ *
+ * 为每个用户在内存中维护一份已点赞帖子的压缩位图（按post_id），
+ * "我是否点赞过"的查询从数据库查询变为内存查找
+ *
+ * 设计要点：
+ * 1. 懒加载：首次访问某用户时才从 post_likes 表加载
+ * 2. 写穿透：点赞/取消点赞事务提交后同步更新缓存
+ * 3. LRU淘汰：按用户数量限制内存（custom_config.liked_post_cache.max_users）
+ * 4. 分片加锁：按user_id分片，降低多IO线程之间的锁竞争
+ * 5. 多进程：修改通过 Redis 发布/订阅通知其他进程丢弃该用户；
+ *    条目超过 max_age_seconds 后重新加载，Redis 不可用时状态最多滞后这么久
+ */
+class LikedPostCache {
+public:
+    using LikedCallback = std::function<void(bool liked)>;
+    using LikedListCallback = std::function<void(const std::vector<int>& liked_post_ids)>;
+    using ErrorCallback = std::function<void(const drogon::orm::DrogonDbException&)>;
+
+    /**
+     * 查询用户是否点赞过某帖子
+     * 缓存命中时同步回调，未命中时先加载再回调
+     * @param ctx 请求上下文（加载时的数据库耗时计入该请求，可为空）
+     */
+    static void isLiked(const RequestContextPtr& ctx, int user_id, int post_id,
+                        LikedCallback&& callback,
+                        ErrorCallback&& errorCallback);
+
+    /**
+     * 批量查询点赞状态
+     * @param post_ids 待查询的帖子ID
+     * @param callback 回调参数为其中已点赞的帖子ID（保持输入顺序）
+     */
+    static void getLikedPostIds(const RequestContextPtr& ctx, int user_id, std::vector<int> post_ids,
+                                LikedListCallback&& callback,
+                                ErrorCallback&& errorCallback);
+
+    /**
+     * 订阅其他进程的失效消息（启动时调用，未启用 Redis 时不做任何事）
+     */
+    static void start();
+
+    /**
+     * 更新点赞状态（事务提交后调用）
+     * 用户未被缓存时忽略，下次访问会重新加载；同时通知其他进程丢弃该用户
+     */
+    static void update(int user_id, int post_id, bool liked);
+
+    /**
+     * 丢弃某用户的缓存
+     */
+    static void invalidate(int user_id);
+
+private:
+    /**
+     * 从数据库加载用户点赞集合并放入缓存
+     * @param onLoaded 加载完成后回调（参数为刚加载的位图）
+     */
+    static void load(const RequestContextPtr& ctx, int user_id,
+                     std::function<void(const RoaringBitmap&)>&& onLoaded,
+                     ErrorCallback&& errorCallback);
+
+    /**
+     * 在缓存中查找用户并执行visitor（持有分片锁）
+     * @return true=命中，false=未缓存
+     */
+    static bool visit(int user_id, const std::function<void(const RoaringBitmap&)>& visitor);
+
+    /**
+     * 每个分片的最大用户数
+     */
+    static size_t shardCapacity();
+
+    /**
+     * 条目的最长存活时间
+     */
+    static std::chrono::steady_clock::duration maxAge();
+};
@@ -0,0 +1,479 @@
+#include "Metrics.h"
+#include "AdmissionController.h"
+#include "LatencyHistogram.h"
+#include "PostPurger.h"
+#include "RedisCache.h"
+#include "RequestContext.h"
+#include "ResponseCache.h"
+#include "SingleFlight.h"
+#include "SqlStatements.h"
+#include "ViewCounter.h"
+#include <drogon/drogon.h>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 最多统计的路由数，超出的路由记入最后一个"other"
+const size_t MAX_ROUTES = 64;
+const size_t OTHER_ROUTE = MAX_ROUTES - 1;
+
+// 直方图输出的桶边界（秒）
+const double BUCKET_BOUNDS_SECONDS[] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+    0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+
+// 输出的分位数
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+/**
+ * 单个路由在单个线程上的统计
+ */
+struct RouteStats {
+    LatencyHistogram latency;
+    LatencyHistogram dbTime;
+    std::atomic<uint64_t> dbQueries{0};
+    // 请求内存池的分配次数，以及其中内存池向堆申请的次数
+    std::atomic<uint64_t> scratchAllocations{0};
+    std::atomic<uint64_t> scratchHeapAllocations{0};
+    // 1xx-5xx 响应数
+    std::array<std::atomic<uint64_t>, 5> statusClasses{};
+};
+
+/**
+ * 线程分片：只由所属线程写入，抓取线程只读
+ */
+struct ThreadShard {
+    std::array<std::atomic<RouteStats*>, MAX_ROUTES> routes{};
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> finished{0};
+};
+
+std::mutex shardsMutex;
+std::vector<ThreadShard*> shards;
+
+ThreadShard& localShard() {
+    // 分片随进程存在，线程退出后其数据仍计入抓取结果
+    thread_local ThreadShard* shard = [] {
+        auto* s = new ThreadShard();
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        shards.push_back(s);
+        return s;
+    }();
+    return *shard;
+}
+
+std::mutex routesMutex;
+std::vector<std::string> routeNames;
+std::unordered_map<std::string, size_t> routeIds;
+
+/**
+ * 路由名 -> 路由ID（全局登记，线程内缓存）
+ */
+size_t routeId(const std::string& route) {
+    thread_local std::unordered_map<std::string, size_t> cache;
+    auto cached = cache.find(route);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    size_t id;
+    {
+        std::lock_guard<std::mutex> lock(routesMutex);
+        auto it = routeIds.find(route);
+        if (it != routeIds.end()) {
+            id = it->second;
+        } else if (routeNames.size() < OTHER_ROUTE) {
+            id = routeNames.size();
+            routeNames.push_back(route);
+            routeIds.emplace(route, id);
+        } else {
+            id = OTHER_ROUTE;
+        }
+    }
+    cache.emplace(route, id);
+    return id;
+}
+
+// 各IO循环最近一次探测到的排队延迟（微秒）
+std::unique_ptr<std::atomic<uint64_t>[]> loopLag;
+size_t loopCount = 0;
+
+uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+std::string formatDouble(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%g", value);
+    return buf;
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            result += '\\';
+            result += c;
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendSample(std::string& out, const std::string& name, const std::string& labels, const std::string& value) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+/**
+ * 输出一个直方图（桶、总和、总数）
+ * @param labels 已格式化的标签，如 route="GET /api/post/list"
+ */
+void appendHistogram(std::string& out, const std::string& name, const std::string& labels,
+                     const LatencyHistogram::Snapshot& snap) {
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    for (double bound : BUCKET_BOUNDS_SECONDS) {
+        auto micros = static_cast<uint64_t>(bound * 1000000);
+        appendSample(out, name + "_bucket", prefix + "le=\"" + formatDouble(bound) + "\"",
+                     std::to_string(snap.countAtOrBelow(micros)));
+    }
+    appendSample(out, name + "_bucket", prefix + "le=\"+Inf\"", std::to_string(snap.total));
+    appendSample(out, name + "_sum", labels, formatDouble(snap.sumMicros / 1e6));
+    appendSample(out, name + "_count", labels, std::to_string(snap.total));
+}
+
+/**
+ * 输出分位数（由直方图估算）
+ */
+void appendQuantiles(std::string& out, const std::string& name, const std::string& labels,
+                     const LatencyHistogram::Snapshot& snap) {
+    if (snap.total == 0) {
+        return;
+    }
+    for (double q : QUANTILES) {
+        appendSample(out, name, labels + ",quantile=\"" + formatDouble(q) + "\"",
+                     formatDouble(snap.percentile(q) / 1e6));
+    }
+}
+
+/**
+ * 合并后的路由统计
+ */
+struct RouteSnapshot {
+    std::string labels;
+    LatencyHistogram::Snapshot latency;
+    LatencyHistogram::Snapshot dbTime;
+    uint64_t dbQueries = 0;
+    uint64_t scratchAllocations = 0;
+    uint64_t scratchHeapAllocations = 0;
+    std::array<uint64_t, 5> statusClasses{};
+};
+
+} // namespace
+
+std::string Metrics::routeName(const drogon::HttpRequestPtr& req) {
+    std::string route = req->methodString();
+    route += ' ';
+    auto pattern = req->matchedPathPattern();
+    if (pattern.empty()) {
+        route += "unmatched";
+    } else {
+        route.append(pattern.data(), pattern.size());
+    }
+    return route;
+}
+
+void Metrics::requestStarted(const drogon::HttpRequestPtr& req) {
+    RequestContext::create(req);
+    localShard().started.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::requestFinished(const drogon::HttpRequestPtr& req,
+                              const drogon::HttpResponsePtr& resp) {
+    auto ctx = RequestContext::get(req);
+    if (!ctx) {
+        return;
+    }
+
+    auto elapsed = ctx->elapsedMicros();
+    auto& shard = localShard();
+
+    auto& slot = shard.routes[routeId(routeName(req))];
+    auto* stats = slot.load(std::memory_order_acquire);
+    if (!stats) {
+        stats = new RouteStats();
+        slot.store(stats, std::memory_order_release);
+    }
+
+    stats->latency.record(elapsed);
+    stats->dbTime.record(ctx->dbMicros.load(std::memory_order_relaxed));
+    stats->dbQueries.fetch_add(ctx->dbQueries.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    stats->scratchAllocations.fetch_add(ctx->arena.allocations(), std::memory_order_relaxed);
+    stats->scratchHeapAllocations.fetch_add(ctx->arena.heapAllocations(), std::memory_order_relaxed);
+
+    int statusClass = static_cast<int>(resp->statusCode()) / 100;
+    if (statusClass >= 1 && statusClass <= 5) {
+        stats->statusClasses[statusClass - 1].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shard.finished.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::startLoopLagProbe() {
+    loopCount = drogon::app().getThreadNum();
+    loopLag.reset(new std::atomic<uint64_t>[loopCount]());
+
+    drogon::app().getLoop()->runEvery(1.0, []() {
+        for (size_t i = 0; i < loopCount; i++) {
+            auto sent = std::chrono::steady_clock::now();
+            drogon::app().getIOLoop(i)->queueInLoop([i, sent]() {
+                loopLag[i].store(microsSince(sent), std::memory_order_relaxed);
+            });
+        }
+    });
+}
+
+std::string Metrics::renderPrometheus() {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(routesMutex);
+        names = routeNames;
+    }
+    names.resize(MAX_ROUTES);
+    names[OTHER_ROUTE] = "other";
+
+    std::vector<ThreadShard*> currentShards;
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        currentShards = shards;
+    }
+
+    // 合并各线程分片（先读finished再读started，保证进行中请求数不为负）
+    uint64_t finished = 0;
+    uint64_t started = 0;
+    for (auto* shard : currentShards) {
+        finished += shard->finished.load(std::memory_order_relaxed);
+    }
+    for (auto* shard : currentShards) {
+        started += shard->started.load(std::memory_order_relaxed);
+    }
+
+    std::vector<RouteSnapshot> routes;
+    for (size_t id = 0; id < MAX_ROUTES; id++) {
+        RouteSnapshot merged;
+        bool seen = false;
+        for (auto* shard : currentShards) {
+            auto* stats = shard->routes[id].load(std::memory_order_acquire);
+            if (!stats) {
+                continue;
+            }
+            seen = true;
+            merged.latency.merge(stats->latency.snapshot());
+            merged.dbTime.merge(stats->dbTime.snapshot());
+            merged.dbQueries += stats->dbQueries.load(std::memory_order_relaxed);
+            merged.scratchAllocations += stats->scratchAllocations.load(std::memory_order_relaxed);
+            merged.scratchHeapAllocations += stats->scratchHeapAllocations.load(std::memory_order_relaxed);
+            for (size_t c = 0; c < merged.statusClasses.size(); c++) {
+                merged.statusClasses[c] += stats->statusClasses[c].load(std::memory_order_relaxed);
+            }
+        }
+        if (seen) {
+            merged.labels = "route=\"" + escapeLabel(names[id]) + "\"";
+            routes.push_back(std::move(merged));
+        }
+    }
+
+    std::string out;
+    out.reserve(64 * 1024);
+
+    // 请求
+    appendHeader(out, "bbs_http_requests_in_flight", "gauge", "Requests currently being handled.");
+    appendSample(out, "bbs_http_requests_in_flight", "",
+                 std::to_string(started > finished ? started - finished : 0));
+
+    appendHeader(out, "bbs_http_request_duration_seconds", "histogram", "Request latency by route.");
+    for (const auto& r : routes) {
+        appendHistogram(out, "bbs_http_request_duration_seconds", r.labels, r.latency);
+    }
+
+    appendHeader(out, "bbs_http_request_duration_quantile_seconds", "gauge",
+                 "Request latency quantiles by route, estimated from the histogram.");
+    for (const auto& r : routes) {
+        appendQuantiles(out, "bbs_http_request_duration_quantile_seconds", r.labels, r.latency);
+    }
+
+    appendHeader(out, "bbs_http_responses_total", "counter", "Responses by route and status class.");
+    for (const auto& r : routes) {
+        for (size_t c = 0; c < r.statusClasses.size(); c++) {
+            if (r.statusClasses[c] > 0) {
+                appendSample(out, "bbs_http_responses_total",
+                             r.labels + ",code=\"" + std::to_string(c + 1) + "xx\"",
+                             std::to_string(r.statusClasses[c]));
+            }
+        }
+    }
+
+    // 每个请求的数据库耗时
+    appendHeader(out, "bbs_http_request_db_seconds", "histogram", "Database time spent per request by route.");
+    for (const auto& r : routes) {
+        appendHistogram(out, "bbs_http_request_db_seconds", r.labels, r.dbTime);
+    }
+
+    appendHeader(out, "bbs_http_request_db_queries_total", "counter", "Database queries issued by route.");
+    for (const auto& r : routes) {
+        appendSample(out, "bbs_http_request_db_queries_total", r.labels, std::to_string(r.dbQueries));
+    }
+
+    appendHeader(out, "bbs_http_request_scratch_allocations_total", "counter",
+                 "Allocations served from the per-request arena by route.");
+    for (const auto& r : routes) {
+        appendSample(out, "bbs_http_request_scratch_allocations_total", r.labels,
+                     std::to_string(r.scratchAllocations));
+    }
+
+    appendHeader(out, "bbs_http_request_scratch_heap_allocations_total", "counter",
+                 "Heap blocks the per-request arena had to request by route.");
+    for (const auto& r : routes) {
+        appendSample(out, "bbs_http_request_scratch_heap_allocations_total", r.labels,
+                     std::to_string(r.scratchHeapAllocations));
+    }
+
+    // IO线程排队延迟
+    appendHeader(out, "bbs_io_loop_lag_seconds", "gauge",
+                 "Time a task queued to the IO loop waited before running (last probe).");
+    for (size_t i = 0; i < loopCount; i++) {
+        appendSample(out, "bbs_io_loop_lag_seconds", "loop=\"" + std::to_string(i) + "\"",
+                     formatDouble(loopLag[i].load(std::memory_order_relaxed) / 1e6));
+    }
+
+    // 准入控制
+    appendHeader(out, "bbs_db_queries_in_flight", "gauge", "Database queries running or queued in the pool.");
+    appendSample(out, "bbs_db_queries_in_flight", "",
+                 std::to_string(AdmissionController::queriesInFlight()));
+
+    appendHeader(out, "bbs_db_overloaded", "gauge",
+                 "1 when query latency stayed above the admission target for a whole interval.");
+    appendSample(out, "bbs_db_overloaded", "", AdmissionController::overloaded() ? "1" : "0");
+
+    appendHeader(out, "bbs_admission_shed_total", "counter", "Requests rejected by admission control.");
+    static const char* priorityNames[] = {"low", "normal", "high"};
+    for (int p = 0; p < AdmissionController::PRIORITY_COUNT; p++) {
+        appendSample(out, "bbs_admission_shed_total",
+                     std::string("priority=\"") + priorityNames[p] + "\"",
+                     std::to_string(AdmissionController::shedCount(
+                         static_cast<AdmissionController::Priority>(p))));
+    }
+
+    // 读请求合并
+    appendHeader(out, "bbs_singleflight_flights_total", "counter", "Reads actually issued by each single-flight group.");
+    for (const auto* group : SingleFlightGroup::all()) {
+        appendSample(out, "bbs_singleflight_flights_total",
+                     std::string("group=\"") + group->name() + "\"",
+                     std::to_string(group->flights()));
+    }
+
+    appendHeader(out, "bbs_singleflight_coalesced_total", "counter",
+                 "Requests served by joining an identical in-flight read.");
+    for (const auto* group : SingleFlightGroup::all()) {
+        appendSample(out, "bbs_singleflight_coalesced_total",
+                     std::string("group=\"") + group->name() + "\"",
+                     std::to_string(group->coalesced()));
+    }
+
+    // 响应缓存
+    appendHeader(out, "bbs_response_cache_requests_total", "counter",
+                 "Response cache lookups by result (fresh, stale or miss).");
+    for (const auto* cache : ResponseCacheBase::all()) {
+        const auto& stats = cache->stats();
+        std::string label = std::string("cache=\"") + cache->name() + "\"";
+        appendSample(out, "bbs_response_cache_requests_total", label + ",result=\"fresh\"",
+                     std::to_string(stats.freshHits.load(std::memory_order_relaxed)));
+        appendSample(out, "bbs_response_cache_requests_total", label + ",result=\"stale\"",
+                     std::to_string(stats.staleHits.load(std::memory_order_relaxed)));
+        appendSample(out, "bbs_response_cache_requests_total", label + ",result=\"miss\"",
+                     std::to_string(stats.misses.load(std::memory_order_relaxed)));
+    }
+
+    appendHeader(out, "bbs_response_cache_refreshes_total", "counter",
+                 "Background refreshes started while serving a cached response.");
+    for (const auto* cache : ResponseCacheBase::all()) {
+        appendSample(out, "bbs_response_cache_refreshes_total",
+                     std::string("cache=\"") + cache->name() + "\"",
+                     std::to_string(cache->stats().refreshes.load(std::memory_order_relaxed)));
+    }
+
+    // 二级缓存
+    appendHeader(out, "bbs_redis_cache_keys_total", "counter", "Shared Redis cache key lookups by result.");
+    appendSample(out, "bbs_redis_cache_keys_total", "result=\"hit\"", std::to_string(RedisCache::hits()));
+    appendSample(out, "bbs_redis_cache_keys_total", "result=\"miss\"", std::to_string(RedisCache::misses()));
+    appendSample(out, "bbs_redis_cache_keys_total", "result=\"error\"", std::to_string(RedisCache::errors()));
+
+    // 已删除帖子的后台清除
+    appendHeader(out, "bbs_post_purge_rows_total", "counter", "Rows removed by the background purge of deleted posts.");
+    appendSample(out, "bbs_post_purge_rows_total", "table=\"posts\"", std::to_string(PostPurger::purgedPosts()));
+    appendSample(out, "bbs_post_purge_rows_total", "table=\"replies\"", std::to_string(PostPurger::purgedReplies()));
+    appendSample(out, "bbs_post_purge_rows_total", "table=\"post_likes\"", std::to_string(PostPurger::purgedLikes()));
+    appendHeader(out, "bbs_post_purge_throttled_total", "counter",
+                 "Times the purge paused for database overload or replication lag.");
+    appendSample(out, "bbs_post_purge_throttled_total", "", std::to_string(PostPurger::throttled()));
+
+    // 尚未写回的浏览次数
+    appendHeader(out, "bbs_view_counter_pending", "gauge", "Post views counted in memory but not yet written back.");
+    appendSample(out, "bbs_view_counter_pending", "", std::to_string(ViewCounter::pending()));
+
+    // SQL语句
+    appendHeader(out, "bbs_sql_executions_total", "counter", "Executions by SQL statement.");
+    for (const auto* stmt : sql::all()) {
+        appendSample(out, "bbs_sql_executions_total",
+                     std::string("statement=\"") + stmt->name() + "\"",
+                     std::to_string(stmt->stats().executions.load(std::memory_order_relaxed)));
+    }
+
+    appendHeader(out, "bbs_sql_errors_total", "counter", "Failed executions by SQL statement.");
+    for (const auto* stmt : sql::all()) {
+        appendSample(out, "bbs_sql_errors_total",
+                     std::string("statement=\"") + stmt->name() + "\"",
+                     std::to_string(stmt->stats().errors.load(std::memory_order_relaxed)));
+    }
+
+    appendHeader(out, "bbs_sql_duration_seconds", "histogram", "Latency by SQL statement.");
+    for (const auto* stmt : sql::all()) {
+        appendHistogram(out, "bbs_sql_duration_seconds",
+                        std::string("statement=\"") + stmt->name() + "\"",
+                        stmt->stats().latency.snapshot());
+    }
+
+    return out;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <string>
+
+/**
+ * 运行指标
+ *
+ * 通过请求钩子统计每个路由的：
+ * - 请求延迟直方图（HDR风格，见 LatencyHistogram）
+ * - 数据库耗时直方图和查询次数（来自 RequestContext）
+ * - 响应状态码分类计数
+ * 以及全局的进行中请求数和IO线程事件循环的排队延迟
+ *
+ * 数据按线程分片保存，每个线程只写自己的分片，记录路径上无锁；
+ * 抓取时合并所有分片，以Prometheus文本格式输出（GET /metrics）
+ */
+class Metrics {
+public:
+    /**
+     * 请求开始（路由前调用）：创建请求上下文，进行中请求数+1
+     */
+    static void requestStarted(const drogon::HttpRequestPtr& req);
+
+    /**
+     * 请求结束（发送响应前调用）：记录延迟、数据库耗时和状态码
+     */
+    static void requestFinished(const drogon::HttpRequestPtr& req,
+                                const drogon::HttpResponsePtr& resp);
+
+    /**
+     * 启动IO线程排队延迟探测（在主循环上每秒向每个IO循环投递一个任务）
+     */
+    static void startLoopLagProbe();
+
+    /**
+     * 请求的路由名：方法 + 路由模板（如 "GET /api/post/list"），未匹配路由时为 "方法 unmatched"
+     * 按模板而非实际路径聚合，避免标签数量无限增长
+     */
+    static std::string routeName(const drogon::HttpRequestPtr& req);
+
+    /**
+     * 以Prometheus文本格式导出全部指标
+     */
+    static std::string renderPrometheus();
+};
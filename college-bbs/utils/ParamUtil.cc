@@ -0,0 +1,45 @@
+#include "ParamUtil.h"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cstring>
+
+bool ParamUtil::parseInt(const char* begin, const char* end, int& value) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        begin++;
+    }
+    if (begin < end && *begin == '+') {
+        begin++;
+    }
+
+    int result;
+    auto parsed = std::from_chars(begin, end, result);
+    if (parsed.ec != std::errc()) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+bool ParamUtil::parseInt(const std::string& text, int& value) {
+    return parseInt(text.data(), text.data() + text.size(), value);
+}
+
+bool ParamUtil::parseIntList(const std::string& text, std::vector<int>& values) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    values.reserve(values.size() + std::count(begin, end, ',') + 1);
+    while (begin < end) {
+        auto comma = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+        const char* itemEnd = comma ? comma : end;
+
+        int value;
+        if (!parseInt(begin, itemEnd, value)) {
+            return false;
+        }
+        values.push_back(value);
+
+        begin = comma ? comma + 1 : end;
+    }
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * 请求参数解析工具类
+ *
+ * 直接在参数字符串上解析，不复制参数表、不创建临时字符串
+ */
+class ParamUtil {
+public:
+    /**
+     * 解析整数（规则与 std::stoi 相同：忽略前导空白和末尾多余字符）
+     * @return false=格式错误或超出int范围（value不变）
+     */
+    static bool parseInt(const std::string& text, int& value);
+
+    /**
+     * 解析逗号分隔的整数列表，如 "1,2,3"
+     * @return false=任意一项格式错误
+     */
+    static bool parseIntList(const std::string& text, std::vector<int>& values);
+
+private:
+    static bool parseInt(const char* begin, const char* end, int& value);
+};
@@ -0,0 +1,276 @@
+#include "PostPurger.h"
+#include "AdmissionController.h"
+#include "ErrorLogger.h"
+#include "PostResponseCache.h"
+#include "ProcessSupervisor.h"
+#include "SqlStatements.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+using namespace drogon::orm;
+
+namespace {
+
+struct PurgerConfig {
+    bool enabled;
+    int batchSize;
+    double idleInterval;
+    double minDelay;
+    double sleepRatio;
+    double backoff;
+    std::string replicaClient;
+    double maxReplicationLag;
+};
+
+const PurgerConfig& config() {
+    static const PurgerConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["post_purger"];
+        PurgerConfig result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.batchSize = std::max(1, c.get("batch_size", 500).asInt());
+        result.idleInterval = std::max(1.0, c.get("idle_interval_seconds", 10.0).asDouble());
+        result.minDelay = std::max(0.0, c.get("min_delay_ms", 50.0).asDouble()) / 1000;
+        result.sleepRatio = std::max(0.0, c.get("sleep_ratio", 1.0).asDouble());
+        result.backoff = std::max(1.0, c.get("backoff_seconds", 5.0).asDouble());
+        result.replicaClient = c.get("replica_client", "").asString();
+        result.maxReplicationLag = c.get("max_replication_lag_seconds", 5.0).asDouble();
+        return result;
+    }();
+    return cfg;
+}
+
+std::atomic<uint64_t> postCount{0};
+std::atomic<uint64_t> replyCount{0};
+std::atomic<uint64_t> likeCount{0};
+std::atomic<uint64_t> throttledCount{0};
+
+// 正在清除的帖子：依次删除回复、点赞、帖子本身
+enum class Phase { REPLIES, LIKES, POST };
+
+/**
+ * 清除进度（同一时间只有一个步骤在执行，步骤之间由定时器串行衔接，不需要加锁）
+ */
+struct Progress {
+    DbClientPtr client;
+    int postId = 0;
+    Phase phase = Phase::REPLIES;
+};
+
+Progress& progress() {
+    static Progress instance;
+    return instance;
+}
+
+void step();
+
+void schedule(double seconds) {
+    drogon::app().getLoop()->runAfter(seconds, step);
+}
+
+void backOff() {
+    throttledCount.fetch_add(1, std::memory_order_relaxed);
+    schedule(config().backoff);
+}
+
+/**
+ * 一批完成后按本批耗时休眠，数据库越慢清除越慢
+ */
+void scheduleAfterBatch(std::chrono::steady_clock::time_point start) {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    schedule(std::max(config().minDelay, elapsed * config().sleepRatio));
+}
+
+void onError(const DrogonDbException& e) {
+    ErrorLogger::logBackgroundError("purge deleted post", e);
+    schedule(config().backoff);
+}
+
+// 从库不支持 SHOW REPLICA STATUS（MySQL 8.0.22 之前）时改用旧语句
+std::atomic<bool> useSlaveStatus{false};
+
+/**
+ * 由复制状态判断是否可以继续
+ */
+bool replicationOk(const Result& r) {
+    // 不是从库时没有结果行
+    if (r.size() == 0) {
+        return true;
+    }
+    for (Result::RowSizeType i = 0; i < r.columns(); i++) {
+        const char* name = r.columnName(i);
+        if (std::strcmp(name, "Seconds_Behind_Source") != 0 &&
+            std::strcmp(name, "Seconds_Behind_Master") != 0) {
+            continue;
+        }
+        // NULL 表示复制已停止
+        if (r[0][i].isNull()) {
+            LOG_WARN << "Post purge paused: replication is not running";
+            return false;
+        }
+        return r[0][i].as<double>() <= config().maxReplicationLag;
+    }
+    return true;
+}
+
+/**
+ * 检查从库复制延迟，callback(是否可以继续)
+ */
+void checkReplicationLag(std::function<void(bool)>&& callback) {
+    const auto& cfg = config();
+    if (cfg.replicaClient.empty()) {
+        callback(true);
+        return;
+    }
+
+    auto replica = drogon::app().getDbClient(cfg.replicaClient);
+    if (!replica) {
+        callback(true);
+        return;
+    }
+    auto shared = std::make_shared<std::function<void(bool)>>(std::move(callback));
+    bool slave = useSlaveStatus.load(std::memory_order_relaxed);
+    replica->execSqlAsync(
+        slave ? "SHOW SLAVE STATUS" : "SHOW REPLICA STATUS",
+        [shared](const Result& r) {
+            (*shared)(replicationOk(r));
+        },
+        [shared, replica, slave](const DrogonDbException& e) {
+            if (slave) {
+                LOG_WARN << "Check replication lag error: " << e.base().what();
+                (*shared)(false);
+                return;
+            }
+            // 旧版本不认识 REPLICA 关键字，改用 SHOW SLAVE STATUS 重试，之后一直使用
+            replica->execSqlAsync(
+                "SHOW SLAVE STATUS",
+                [shared](const Result& r) {
+                    useSlaveStatus.store(true, std::memory_order_relaxed);
+                    (*shared)(replicationOk(r));
+                },
+                [shared](const DrogonDbException& e) {
+                    LOG_WARN << "Check replication lag error: " << e.base().what();
+                    (*shared)(false);
+                });
+        });
+}
+
+void purgeBatch() {
+    auto& p = progress();
+    auto start = std::chrono::steady_clock::now();
+    int batchSize = config().batchSize;
+
+    switch (p.phase) {
+        case Phase::REPLIES:
+            sql::execAsync(
+                nullptr, p.client, sql::REPLY_PURGE_BATCH,
+                [start, batchSize](const Result& r) {
+                    replyCount.fetch_add(r.affectedRows(), std::memory_order_relaxed);
+                    if (r.affectedRows() < static_cast<size_t>(batchSize)) {
+                        progress().phase = Phase::LIKES;
+                    }
+                    scheduleAfterBatch(start);
+                },
+                onError,
+                p.postId, batchSize
+            );
+            break;
+        case Phase::LIKES:
+            sql::execAsync(
+                nullptr, p.client, sql::LIKE_PURGE_BATCH,
+                [start, batchSize](const Result& r) {
+                    likeCount.fetch_add(r.affectedRows(), std::memory_order_relaxed);
+                    if (r.affectedRows() < static_cast<size_t>(batchSize)) {
+                        progress().phase = Phase::POST;
+                    }
+                    scheduleAfterBatch(start);
+                },
+                onError,
+                p.postId, batchSize
+            );
+            break;
+        case Phase::POST:
+            sql::execAsync(
+                nullptr, p.client, sql::POST_PURGE,
+                [start](const Result& r) {
+                    postCount.fetch_add(r.affectedRows(), std::memory_order_relaxed);
+                    // 帖子已不存在，它的二级缓存代数键不再需要
+                    PostResponseCache::forgetDetail(progress().postId);
+                    progress().postId = 0;
+                    scheduleAfterBatch(start);
+                },
+                onError,
+                p.postId
+            );
+            break;
+    }
+}
+
+/**
+ * 取下一个待清除的帖子
+ */
+void purgeNext() {
+    sql::execAsync(
+        nullptr, progress().client, sql::POST_PURGE_NEXT,
+        [](const Result& r) {
+            if (r.size() == 0) {
+                schedule(config().idleInterval);
+                return;
+            }
+            auto& p = progress();
+            p.postId = r[0]["id"].as<int>();
+            p.phase = Phase::REPLIES;
+            purgeBatch();
+        },
+        onError
+    );
+}
+
+void step() {
+    if (AdmissionController::overloaded()) {
+        backOff();
+        return;
+    }
+
+    checkReplicationLag([](bool ok) {
+        if (!ok) {
+            backOff();
+            return;
+        }
+        if (progress().postId == 0) {
+            purgeNext();
+        } else {
+            purgeBatch();
+        }
+    });
+}
+
+} // namespace
+
+void PostPurger::start(const DbClientPtr& client) {
+    // 多进程模式下只由0号工作进程清除
+    if (!config().enabled || ProcessSupervisor::workerIndex() != 0) {
+        return;
+    }
+    progress().client = client;
+    schedule(config().idleInterval);
+}
+
+uint64_t PostPurger::purgedPosts() {
+    return postCount.load(std::memory_order_relaxed);
+}
+
+uint64_t PostPurger::purgedReplies() {
+    return replyCount.load(std::memory_order_relaxed);
+}
+
+uint64_t PostPurger::purgedLikes() {
+    return likeCount.load(std::memory_order_relaxed);
+}
+
+uint64_t PostPurger::throttled() {
+    return throttledCount.load(std::memory_order_relaxed);
+}
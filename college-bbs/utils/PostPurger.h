@@ -0,0 +1,51 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <cstdint>
+
+/**
+ * 已删除帖子的后台清除
+ *
+ * 删帖只是给帖子打上 deleted_at 标记（所有读取都过滤已删除的帖子），请求立即返回。
+ * 以前直接 DELETE 帖子，由外键级联在同一个请求里删除全部回复和点赞，
+ * 热门帖子一次要删几万行，锁住大量行、响应很慢，还会让从库复制延迟陡增。
+ * 这里在后台逐个处理已删除的帖子：先按 batch_size 分批删除回复，再分批删除点赞，
+ * 最后删除帖子本身（此时已没有可级联删除的行）
+ *
+ * 限速：
+ * 1. 每批之后休眠 max(min_delay_ms, 本批耗时 * sleep_ratio)，数据库变慢时自动放慢
+ * 2. 准入控制判定数据库过载时暂停 backoff_seconds
+ * 3. 配置了 replica_client 时每批前检查从库复制延迟，
+ *    超过 max_replication_lag_seconds（或复制已停止）时暂停 backoff_seconds
+ *    （SHOW REPLICA STATUS 不支持时改用 SHOW SLAVE STATUS，兼容 MySQL 8.0.22 之前的版本）
+ *
+ * 多进程模式下只在0号工作进程中运行，避免多个进程同时清除同一个帖子；
+ * 多实例部署时只在一个实例上启用
+ *
+ * 配置（custom_config.post_purger）：
+ * - enabled: 是否启用
+ * - batch_size: 每批删除的行数
+ * - idle_interval_seconds: 没有待清除的帖子时的检查间隔
+ * - min_delay_ms / sleep_ratio / backoff_seconds: 见上
+ * - replica_client: 用于检查复制延迟的数据库客户端名（db_clients 中的从库），空=不检查
+ * - max_replication_lag_seconds: 允许的复制延迟
+ */
+class PostPurger {
+public:
+    /**
+     * 开始后台清除（启动时调用一次）
+     */
+    static void start(const drogon::orm::DbClientPtr& client);
+
+    /**
+     * 已清除的行数
+     */
+    static uint64_t purgedPosts();
+    static uint64_t purgedReplies();
+    static uint64_t purgedLikes();
+
+    /**
+     * 因过载或复制延迟暂停的次数
+     */
+    static uint64_t throttled();
+};
@@ -0,0 +1,182 @@
+#include "PostResponseCache.h"
+#include "RedisCache.h"
+#include "ResponseCache.h"
+#include "ResponseUtil.h"
+#include <drogon/drogon.h>
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Result = PostResponseCache::Result;
+
+// 失效消息频道：消息为 "list <代数>" 或 "detail <帖子ID>"
+const char* const INVALIDATE_CHANNEL = "post:invalidate";
+
+// 列表页二级缓存的代数：失效时自增，旧代数的键不再被读取，随过期时间清除
+const char* const LIST_GENERATION_KEY = "post:list:gen";
+
+// 错误结果不缓存
+bool isCacheable(const Result& result) {
+    return result.code == ResponseUtil::SUCCESS;
+}
+
+// 帖子列表按 (page, size) 合并，键为 page << 32 | size
+SingleFlight<uint64_t, Result> listFlight("post_list");
+ResponseCache<uint64_t, Result> listCache("post_list", listFlight, isCacheable);
+
+// 帖子详情按帖子ID合并
+SingleFlight<int, Result> detailFlight("post_detail");
+ResponseCache<int, Result> detailCache("post_detail", detailFlight, isCacheable);
+
+std::atomic<int64_t> listGeneration{0};
+
+/**
+ * 收到更新的列表代数：只前进不后退
+ */
+void advanceListGeneration(int64_t generation) {
+    int64_t current = listGeneration.load(std::memory_order_relaxed);
+    while (generation > current &&
+           !listGeneration.compare_exchange_weak(current, generation, std::memory_order_relaxed)) {
+    }
+}
+
+std::string detailKey(int post_id) {
+    return "post:detail:" + std::to_string(post_id);
+}
+
+// 帖子详情二级缓存的代数：失效时自增
+std::string detailGenerationKey(int post_id) {
+    return "post:detail:gen:" + std::to_string(post_id);
+}
+
+/**
+ * 包装读取：先查二级缓存，未命中再查数据库，成功结果写回二级缓存
+ * 键中带有读取时的列表代数，失效后写回的旧结果不会再被读到
+ */
+PostResponseCache::Fetch withRedis(std::string key, PostResponseCache::Fetch&& fetch) {
+    if (!RedisCache::enabled()) {
+        return std::move(fetch);
+    }
+
+    return [key = std::move(key), fetch = std::move(fetch)](PostResponseCache::Done done) {
+        RedisCache::get(key, [key, fetch, done](const RedisCache::Value& cached) {
+            if (cached) {
+                done(PostResponseCache::success(*cached));
+                return;
+            }
+            fetch(PostResponseCache::Done([key, done](PostResponseCache::ResultPtr result) {
+                if (isCacheable(*result)) {
+                    RedisCache::set(key, result->data, RedisCache::postTtl());
+                }
+                return done(std::move(result));
+            }));
+        });
+    };
+}
+
+/**
+ * 包装帖子详情的读取：值为 "<代数>\n<data>"，与代数键一起用MGET读取，代数不一致视为未命中
+ * 写回时带上读取开始时的代数，失效（代数自增）后才写回的旧结果不会再被读到
+ */
+PostResponseCache::Fetch withRedisDetail(int post_id, PostResponseCache::Fetch&& fetch) {
+    if (!RedisCache::enabled()) {
+        return std::move(fetch);
+    }
+
+    return [post_id, fetch = std::move(fetch)](PostResponseCache::Done done) {
+        std::vector<std::string> keys{detailGenerationKey(post_id), detailKey(post_id)};
+        RedisCache::mget(keys, [post_id, fetch, done](const std::vector<RedisCache::Value>& values) {
+            std::string generation = values[0] ? *values[0] : "0";
+            const auto& cached = values[1];
+            if (cached && cached->size() > generation.size() &&
+                cached->compare(0, generation.size(), generation) == 0 && (*cached)[generation.size()] == '\n') {
+                done(PostResponseCache::success(cached->substr(generation.size() + 1)));
+                return;
+            }
+            fetch(PostResponseCache::Done([post_id, generation, done](PostResponseCache::ResultPtr result) {
+                if (isCacheable(*result)) {
+                    RedisCache::set(detailKey(post_id), generation + "\n" + result->data, RedisCache::postTtl());
+                }
+                return done(std::move(result));
+            }));
+        });
+    };
+}
+
+} // namespace
+
+void PostResponseCache::start() {
+    if (!RedisCache::enabled()) {
+        return;
+    }
+
+    RedisCache::subscribe(INVALIDATE_CHANNEL, [](const std::string& message) {
+        if (message.compare(0, 5, "list ") == 0) {
+            advanceListGeneration(std::atoll(message.c_str() + 5));
+            listCache.clear();
+        } else if (message.compare(0, 7, "detail ") == 0) {
+            detailCache.invalidate(std::atoi(message.c_str() + 7));
+        }
+    });
+
+    RedisCache::get(LIST_GENERATION_KEY, [](const RedisCache::Value& value) {
+        if (value) {
+            advanceListGeneration(std::atoll(value->c_str()));
+        }
+    });
+}
+
+void PostResponseCache::list(int page, int size, Fetch&& fetch, Callback&& callback) {
+    uint64_t key = static_cast<uint64_t>(page) << 32 | static_cast<uint32_t>(size);
+    std::string redisKey = "post:list:" + std::to_string(listGeneration.load(std::memory_order_relaxed)) +
+                           ":" + std::to_string(page) + ":" + std::to_string(size);
+    listCache.get(key, withRedis(std::move(redisKey), std::move(fetch)), std::move(callback));
+}
+
+void PostResponseCache::detail(int post_id, Fetch&& fetch, Callback&& callback) {
+    detailCache.get(post_id, withRedisDetail(post_id, std::move(fetch)), std::move(callback));
+}
+
+void PostResponseCache::invalidateLists() {
+    listCache.clear();
+
+    // 其他进程收到新代数后清空自己的列表页
+    RedisCache::incr(LIST_GENERATION_KEY, [](int64_t generation) {
+        advanceListGeneration(generation);
+        RedisCache::publish(INVALIDATE_CHANNEL, "list " + std::to_string(generation));
+    });
+}
+
+void PostResponseCache::invalidateDetail(int post_id) {
+    detailCache.invalidate(post_id);
+
+    // 代数自增后再通知其他进程，它们重新读取时不会命中旧的二级缓存
+    RedisCache::incr(detailGenerationKey(post_id), [post_id](int64_t) {
+        RedisCache::publish(INVALIDATE_CHANNEL, "detail " + std::to_string(post_id));
+    });
+}
+
+void PostResponseCache::forgetDetail(int post_id) {
+    RedisCache::del(detailGenerationKey(post_id));
+    RedisCache::del(detailKey(post_id));
+}
+
+PostResponseCache::ResultPtr PostResponseCache::success(std::string data) {
+    return std::make_shared<const Result>(Result{ResponseUtil::SUCCESS, "", std::move(data), ""});
+}
+
+PostResponseCache::ResultPtr PostResponseCache::error(int code, std::string msg, std::string errorId) {
+    return std::make_shared<const Result>(Result{code, std::move(msg), "", std::move(errorId)});
+}
+
+drogon::HttpResponsePtr PostResponseCache::toResponse(const ResultPtr& result) {
+    if (result->code != ResponseUtil::SUCCESS) {
+        if (!result->errorId.empty()) {
+            return ResponseUtil::error(result->code, result->msg, result->errorId);
+        }
+        return ResponseUtil::error(result->code, result->msg);
+    }
+    return ResponseUtil::successRaw(result->data);
+}
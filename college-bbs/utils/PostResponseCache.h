@@ -0,0 +1,80 @@
+#pragma once
+
+#include "SingleFlight.h"
+#include <drogon/HttpResponse.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * 帖子列表和帖子详情的响应缓存
+ *
+ * 读取经 SingleFlight 合并、经 ResponseCache 缓存（stale-while-revalidate），
+ * 结果为序列化好的data字段，由所有请求共享，每个请求各自构造响应
+ *
+ * 数据变化且需要立即可见时主动失效：
+ * - 发帖/删帖：清空全部列表页
+ * - 删帖、发表/删除回复：失效该帖子的详情
+ * 点赞数和浏览次数的变化不失效，最多延迟一个 ttl
+ *
+ * 启用 RedisCache 时，一级缓存未命中先查Redis中的二级缓存；
+ * 失效操作同时删除二级缓存并通过发布/订阅通知其他进程删除各自的一级缓存。
+ * 列表页的二级缓存键带代数，帖子详情的二级缓存值带该帖子的代数，失效时代数自增，
+ * 失效前开始、失效后才写回的旧结果不会再被读到，旧值随过期时间清除
+ */
+class PostResponseCache {
+public:
+    /**
+     * 读取结果
+     */
+    struct Result {
+        int code;           // ResponseUtil::SUCCESS 或错误码
+        std::string msg;    // 错误消息
+        std::string data;   // 成功时为序列化后的data字段
+        std::string errorId;  // 出错时的错误ID（可为空）
+    };
+
+    using ResultPtr = std::shared_ptr<const Result>;
+    using Done = SingleFlight<int, Result>::Done;
+    using Fetch = std::function<void(Done)>;
+    using Callback = std::function<void(const ResultPtr&)>;
+
+    /**
+     * 订阅其他进程的失效消息（启动时调用一次）
+     */
+    static void start();
+
+    /**
+     * 读取一页帖子列表（按 page, size 缓存）
+     */
+    static void list(int page, int size, Fetch&& fetch, Callback&& callback);
+
+    /**
+     * 读取帖子详情（按帖子ID缓存）
+     */
+    static void detail(int post_id, Fetch&& fetch, Callback&& callback);
+
+    /**
+     * 清空全部列表页
+     */
+    static void invalidateLists();
+
+    /**
+     * 失效一个帖子的详情
+     */
+    static void invalidateDetail(int post_id);
+
+    /**
+     * 帖子已从数据库中清除：删除它在二级缓存中的详情和代数键
+     * （代数键不设过期时间，过期后从0重新计数可能与仍未过期的旧值重合）
+     */
+    static void forgetDetail(int post_id);
+
+    static ResultPtr success(std::string data);
+    static ResultPtr error(int code, std::string msg, std::string errorId = "");
+
+    /**
+     * 由读取结果构造响应
+     */
+    static drogon::HttpResponsePtr toResponse(const ResultPtr& result);
+};
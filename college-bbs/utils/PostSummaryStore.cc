@@ -0,0 +1,265 @@
+#include "PostSummaryStore.h"
+#include <drogon/drogon.h>
+#include <json/writer.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 分片数量
+const size_t SHARD_COUNT = 16;
+
+// 内存池每块大小
+const size_t CHUNK_SIZE = 64 * 1024;
+
+// 计数字段宽度（int最大值为10位）
+const size_t COUNTER_WIDTH = 10;
+
+enum Counter {
+    VIEW_COUNT = 0,
+    LIKE_COUNT = 1,
+    REPLY_COUNT = 2,
+    COUNTER_COUNT = 3
+};
+
+struct StoreConfig {
+    bool enabled;
+    size_t shardCapacity;
+    Clock::duration maxAge;
+};
+
+const StoreConfig& config() {
+    static const StoreConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["post_summary_cache"];
+        StoreConfig result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.shardCapacity = std::max<size_t>(1, c.get("max_posts", 100000).asUInt64() / SHARD_COUNT);
+        result.maxAge = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(c.get("max_age_seconds", 30.0).asDouble()));
+        return result;
+    }();
+    return cfg;
+}
+
+/**
+ * 只分配不单独释放的内存池，整体释放
+ */
+class Arena {
+public:
+    char* allocate(size_t size) {
+        if (size > remaining_) {
+            // 超过一块大小的片段单独分配，不影响当前块
+            if (size > CHUNK_SIZE) {
+                chunks_.emplace_back(new char[size]);
+                allocated_ += size;
+                return chunks_.back().get();
+            }
+            chunks_.emplace_back(new char[CHUNK_SIZE]);
+            allocated_ += CHUNK_SIZE;
+            current_ = chunks_.back().get();
+            remaining_ = CHUNK_SIZE;
+        }
+        char* result = current_;
+        current_ += size;
+        remaining_ -= size;
+        return result;
+    }
+
+    size_t allocatedBytes() const { return allocated_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* current_ = nullptr;
+    size_t remaining_ = 0;
+    size_t allocated_ = 0;
+};
+
+struct Entry {
+    char* data;
+    uint32_t size;
+    uint32_t offsets[COUNTER_COUNT];  // 各计数字段在片段中的位置
+    int counters[COUNTER_COUNT];
+    Clock::time_point loadedAt;
+};
+
+struct Shard {
+    std::mutex mutex;
+    std::unordered_map<int, Entry> entries;
+    Arena arena;
+    size_t liveBytes = 0;
+};
+
+Shard& shardFor(int post_id) {
+    static Shard shards[SHARD_COUNT];
+    return shards[static_cast<unsigned int>(post_id) % SHARD_COUNT];
+}
+
+/**
+ * 把计数写入固定宽度的字段（右对齐，左侧补空格）
+ */
+void writeCounter(char* field, int value) {
+    char buf[COUNTER_WIDTH + 1];
+    std::snprintf(buf, sizeof(buf), "%*d", static_cast<int>(COUNTER_WIDTH), std::max(0, value));
+    std::memcpy(field, buf, COUNTER_WIDTH);
+}
+
+/**
+ * 渲染片段，字段按字母顺序（与 Json::Value 序列化结果一致）
+ */
+std::string render(const PostSummary& summary, uint32_t* offsets) {
+    std::string out;
+    out.reserve(192 + summary.title.size() + summary.author.size());
+
+    auto counterField = [&out, offsets](Counter counter, int value) {
+        offsets[counter] = static_cast<uint32_t>(out.size());
+        out.append(COUNTER_WIDTH, ' ');
+        writeCounter(&out[offsets[counter]], value);
+    };
+
+    out += "{\"author\":";
+    out += Json::valueToQuotedString(summary.author.c_str());
+    out += ",\"author_id\":";
+    out += std::to_string(summary.author_id);
+    out += ",\"created_at\":";
+    out += Json::valueToQuotedString(summary.created_at.c_str());
+    out += ",\"id\":";
+    out += std::to_string(summary.id);
+    out += ",\"like_count\":";
+    counterField(LIKE_COUNT, summary.like_count);
+    out += ",\"reply_count\":";
+    counterField(REPLY_COUNT, summary.reply_count);
+    out += ",\"title\":";
+    out += Json::valueToQuotedString(summary.title.c_str());
+    out += ",\"view_count\":";
+    counterField(VIEW_COUNT, summary.view_count);
+    out += "}";
+    return out;
+}
+
+/**
+ * 浪费空间过半时把存活片段复制到新内存池（持有分片锁）
+ */
+void compactIfNeeded(Shard& shard) {
+    size_t allocated = shard.arena.allocatedBytes();
+    if (allocated < 4 * CHUNK_SIZE || allocated < 2 * shard.liveBytes) {
+        return;
+    }
+
+    Arena compacted;
+    for (auto& item : shard.entries) {
+        char* data = compacted.allocate(item.second.size);
+        std::memcpy(data, item.second.data, item.second.size);
+        item.second.data = data;
+    }
+    shard.arena = std::move(compacted);
+}
+
+/**
+ * 修改已缓存片段的某个计数
+ */
+template <typename Update>
+void patchCounter(int post_id, Counter counter, Update&& update) {
+    if (!config().enabled) {
+        return;
+    }
+
+    auto& shard = shardFor(post_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(post_id);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    auto& entry = it->second;
+    entry.counters[counter] = std::max(0, update(entry.counters[counter]));
+    writeCounter(entry.data + entry.offsets[counter], entry.counters[counter]);
+}
+
+} // namespace
+
+bool PostSummaryStore::appendTo(int post_id, std::string& out) {
+    if (!config().enabled) {
+        return false;
+    }
+
+    auto& shard = shardFor(post_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(post_id);
+    if (it == shard.entries.end()) {
+        return false;
+    }
+    if (Clock::now() - it->second.loadedAt > config().maxAge) {
+        return false;
+    }
+    out.append(it->second.data, it->second.size);
+    return true;
+}
+
+std::string PostSummaryStore::put(const PostSummary& summary) {
+    Entry entry;
+    std::string fragment = render(summary, entry.offsets);
+    if (!config().enabled) {
+        return fragment;
+    }
+
+    entry.size = static_cast<uint32_t>(fragment.size());
+    entry.counters[VIEW_COUNT] = std::max(0, summary.view_count);
+    entry.counters[LIKE_COUNT] = std::max(0, summary.like_count);
+    entry.counters[REPLY_COUNT] = std::max(0, summary.reply_count);
+    entry.loadedAt = Clock::now();
+
+    auto& shard = shardFor(summary.id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(summary.id);
+    if (it != shard.entries.end()) {
+        shard.liveBytes -= it->second.size;
+        shard.entries.erase(it);
+    } else if (shard.entries.size() >= config().shardCapacity) {
+        // 分片已满：整体清空重新积累
+        shard.entries.clear();
+        shard.arena = Arena();
+        shard.liveBytes = 0;
+    }
+
+    entry.data = shard.arena.allocate(entry.size);
+    std::memcpy(entry.data, fragment.data(), entry.size);
+    shard.entries.emplace(summary.id, entry);
+    shard.liveBytes += entry.size;
+
+    compactIfNeeded(shard);
+    return fragment;
+}
+
+void PostSummaryStore::setLikeCount(int post_id, int like_count) {
+    patchCounter(post_id, LIKE_COUNT, [like_count](int) { return like_count; });
+}
+
+void PostSummaryStore::addReplyCount(int post_id, int delta) {
+    patchCounter(post_id, REPLY_COUNT, [delta](int current) { return current + delta; });
+}
+
+void PostSummaryStore::remove(int post_id) {
+    if (!config().enabled) {
+        return;
+    }
+
+    auto& shard = shardFor(post_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(post_id);
+    if (it != shard.entries.end()) {
+        shard.liveBytes -= it->second.size;
+        shard.entries.erase(it);
+        compactIfNeeded(shard);
+    }
+}
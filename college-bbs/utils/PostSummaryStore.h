@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+/**
+ * 帖子摘要（帖子列表中的一项）
+ */
+struct PostSummary {
+    int id = 0;
+    std::string title;
+    int author_id = 0;
+    std::string author;
+    int view_count = 0;
+    int like_count = 0;
+    int reply_count = 0;
+    std::string created_at;
+};
+
+/**
+ * 预渲染的帖子摘要
+ *
+ * 帖子列表每次请求都要把每一行转成 Json::Value 再序列化。
+ * 这里为每个帖子缓存一段已经序列化好的JSON对象（id、标题、作者、计数），
+ * 列表接口直接按顺序拼接，每个帖子只需一次内存拷贝
+ *
+ * 设计要点：
+ * 1. 计数字段（view_count / like_count / reply_count）在片段中固定宽度（左侧空格补齐），
+ *    点赞、回复变化时直接改写片段中对应的字节，不重新渲染
+ * 2. 片段存放在按分片划分的内存池（arena）中，大块分配、整体释放；
+ *    被替换或删除的片段占用的空间在浪费过半时通过整理回收
+ * 3. 片段超过 max_age_seconds 视为过期，重新从数据库加载（限制多实例部署时的不一致时间）
+ *
+ * 配置（custom_config.post_summary_cache）：
+ * - enabled: 是否启用
+ * - max_posts: 最多缓存的帖子数
+ * - max_age_seconds: 片段有效期
+ */
+class PostSummaryStore {
+public:
+    /**
+     * 把帖子的摘要片段追加到out
+     * @return false=未缓存或已过期（out不变）
+     */
+    static bool appendTo(int post_id, std::string& out);
+
+    /**
+     * 渲染并缓存摘要
+     * @return 渲染出的JSON片段
+     */
+    static std::string put(const PostSummary& summary);
+
+    /**
+     * 设置点赞数（点赞/取消点赞事务提交后调用，未缓存时忽略）
+     */
+    static void setLikeCount(int post_id, int like_count);
+
+    /**
+     * 增减回复数（发表/删除回复事务提交后调用，未缓存时忽略）
+     */
+    static void addReplyCount(int post_id, int delta);
+
+    /**
+     * 删除帖子的摘要
+     */
+    static void remove(int post_id);
+};
@@ -0,0 +1,480 @@
+#include "ProcessSupervisor.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// 监管进程传给工作进程的环境变量
+const char* const ENV_INDEX = "BBS_WORKER_INDEX";
+const char* const ENV_COUNT = "BBS_WORKER_COUNT";
+const char* const ENV_CPUS = "BBS_WORKER_CPUS";
+const char* const ENV_READY_FD = "BBS_READY_FD";
+
+// 工作进程启动后这么短时间内退出，重启前先等待，避免反复崩溃时空转
+const auto MIN_WORKER_LIFETIME = std::chrono::seconds(1);
+
+using Clock = std::chrono::steady_clock;
+using CpuList = std::vector<int>;
+
+struct SupervisorConfig {
+    std::string workers;
+    bool pinThreads;
+    int startupTimeout;
+    int shutdownTimeout;
+};
+
+const Json::Value& multiProcessConfig(const Json::Value& config) {
+    return config["custom_config"]["multi_process"];
+}
+
+SupervisorConfig readConfig(const Json::Value& config) {
+    const auto& c = multiProcessConfig(config);
+    SupervisorConfig result;
+    result.workers = c.get("workers", "auto").asString();
+    result.pinThreads = c.get("pin_threads", true).asBool();
+    result.startupTimeout = std::max(1, c.get("startup_timeout_seconds", 30).asInt());
+    result.shutdownTimeout = std::max(1, c.get("shutdown_timeout_seconds", 30).asInt());
+    return result;
+}
+
+/**
+ * 解析 "0-3,8,10-11" 形式的CPU列表（/sys 的 cpulist 格式）
+ */
+CpuList parseCpuList(const std::string& text) {
+    CpuList cpus;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(pos, end - pos);
+        size_t dash = item.find('-');
+        if (!item.empty() && item[0] >= '0' && item[0] <= '9') {
+            int first = std::atoi(item.c_str());
+            int last = dash == std::string::npos ? first : std::atoi(item.c_str() + dash + 1);
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+std::string formatCpuList(const CpuList& cpus) {
+    std::string text;
+    for (int cpu : cpus) {
+        if (!text.empty()) {
+            text += ',';
+        }
+        text += std::to_string(cpu);
+    }
+    return text;
+}
+
+/**
+ * 本进程允许使用的CPU（容器的cpuset限制也会体现在这里）
+ */
+CpuList allowedCpus() {
+    CpuList cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    if (cpus.empty()) {
+        unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < count; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+/**
+ * 各NUMA节点上允许使用的CPU（读不到节点信息时视为一个节点）
+ */
+std::vector<CpuList> numaNodes(const CpuList& allowed) {
+    std::vector<CpuList> nodes;
+    for (int node = 0;; node++) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+        std::string text;
+        std::getline(file, text);
+
+        CpuList cpus;
+        for (int cpu : parseCpuList(text)) {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+    if (nodes.empty()) {
+        nodes.push_back(allowed);
+    }
+    return nodes;
+}
+
+/**
+ * 按配置把允许使用的CPU分给各工作进程
+ */
+std::vector<CpuList> workerGroups(const SupervisorConfig& cfg) {
+    CpuList allowed = allowedCpus();
+    if (cfg.workers == "numa") {
+        return numaNodes(allowed);
+    }
+
+    size_t count = allowed.size();
+    if (cfg.workers != "auto") {
+        count = static_cast<size_t>(std::max(1, std::atoi(cfg.workers.c_str())));
+    }
+
+    // 均分，前 allowed.size() % count 组多分一个核；进程数多于核数时轮流共用
+    std::vector<CpuList> groups(count);
+    if (count >= allowed.size()) {
+        for (size_t i = 0; i < count; i++) {
+            groups[i].push_back(allowed[i % allowed.size()]);
+        }
+        return groups;
+    }
+    size_t base = allowed.size() / count;
+    size_t extra = allowed.size() % count;
+    size_t next = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t size = base + (i < extra ? 1 : 0);
+        groups[i].assign(allowed.begin() + next, allowed.begin() + next + size);
+        next += size;
+    }
+    return groups;
+}
+
+cpu_set_t toCpuSet(const CpuList& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return set;
+}
+
+/**
+ * 监管进程
+ */
+class Supervisor {
+public:
+    Supervisor(char* argv[], const Json::Value& config)
+        : argv_(argv), cfg_(readConfig(config)), groups_(workerGroups(cfg_)) {
+        slots_.resize(groups_.size());
+    }
+
+    int run() {
+        char path[4096];
+        ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        if (length <= 0) {
+            LOG_ERROR << "Supervisor: cannot resolve executable path: " << std::strerror(errno);
+            return 1;
+        }
+        exe_.assign(path, static_cast<size_t>(length));
+
+        // 信号统一由 sigwaitinfo 同步处理
+        sigemptyset(&signals_);
+        sigaddset(&signals_, SIGCHLD);
+        sigaddset(&signals_, SIGTERM);
+        sigaddset(&signals_, SIGINT);
+        sigaddset(&signals_, SIGHUP);
+        sigprocmask(SIG_BLOCK, &signals_, nullptr);
+
+        LOG_INFO << "Supervisor: starting " << groups_.size() << " workers";
+        for (size_t slot = 0; slot < slots_.size(); slot++) {
+            slots_[slot].pid = spawn(slot, nullptr);
+        }
+
+        while (true) {
+            siginfo_t info;
+            if (sigwaitinfo(&signals_, &info) < 0) {
+                continue;
+            }
+            switch (info.si_signo) {
+                case SIGCHLD:
+                    respawnExited();
+                    break;
+                case SIGHUP:
+                    rollingRestart();
+                    break;
+                default:
+                    shutdown();
+                    return 0;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        pid_t pid = -1;
+        Clock::time_point startedAt;
+    };
+
+    /**
+     * 启动一个工作进程
+     * @param readyFd 非空时建立就绪通知管道，返回读端
+     */
+    pid_t spawn(size_t slot, int* readyFd) {
+        int fds[2] = {-1, -1};
+        if (readyFd && pipe2(fds, O_CLOEXEC) != 0) {
+            LOG_ERROR << "Supervisor: pipe failed: " << std::strerror(errno);
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            // 子进程（监管进程是单线程的，fork 后可以安全地设置环境变量）
+            sigprocmask(SIG_UNBLOCK, &signals_, nullptr);
+            setenv(ENV_INDEX, std::to_string(slot).c_str(), 1);
+            setenv(ENV_COUNT, std::to_string(slots_.size()).c_str(), 1);
+            setenv(ENV_CPUS, formatCpuList(groups_[slot]).c_str(), 1);
+            if (readyFd) {
+                close(fds[0]);
+                fcntl(fds[1], F_SETFD, 0);
+                setenv(ENV_READY_FD, std::to_string(fds[1]).c_str(), 1);
+            } else {
+                unsetenv(ENV_READY_FD);
+            }
+            if (cfg_.pinThreads) {
+                cpu_set_t set = toCpuSet(groups_[slot]);
+                sched_setaffinity(0, sizeof(set), &set);
+            }
+            execv(exe_.c_str(), argv_);
+            _exit(127);
+        }
+
+        if (readyFd) {
+            close(fds[1]);
+            if (pid < 0) {
+                close(fds[0]);
+            } else {
+                *readyFd = fds[0];
+            }
+        }
+        if (pid < 0) {
+            LOG_ERROR << "Supervisor: fork failed: " << std::strerror(errno);
+            return -1;
+        }
+
+        slots_[slot].startedAt = Clock::now();
+        LOG_INFO << "Supervisor: worker " << slot << " started, pid " << pid
+                 << ", cpus " << formatCpuList(groups_[slot]);
+        return pid;
+    }
+
+    /**
+     * 等待新进程就绪（开始监听）
+     */
+    bool waitReady(int fd) {
+        pollfd pfd{fd, POLLIN, 0};
+        int n = poll(&pfd, 1, cfg_.startupTimeout * 1000);
+        char byte = 0;
+        bool ready = n > 0 && read(fd, &byte, 1) == 1;
+        close(fd);
+        return ready;
+    }
+
+    /**
+     * 等待指定进程退出，超时后强制结束
+     */
+    void waitExit(pid_t pid) {
+        auto deadline = Clock::now() + std::chrono::seconds(cfg_.shutdownTimeout);
+        while (Clock::now() < deadline) {
+            if (waitpid(pid, nullptr, WNOHANG) != 0) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        LOG_WARN << "Supervisor: worker pid " << pid << " did not exit in time, killing";
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+
+    /**
+     * 回收退出的工作进程并原位重启
+     */
+    void respawnExited() {
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (size_t slot = 0; slot < slots_.size(); slot++) {
+                if (slots_[slot].pid != pid) {
+                    continue;
+                }
+                LOG_ERROR << "Supervisor: worker " << slot << " (pid " << pid << ") exited with status "
+                          << (WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status))
+                          << ", restarting";
+                if (Clock::now() - slots_[slot].startedAt < MIN_WORKER_LIFETIME) {
+                    std::this_thread::sleep_for(MIN_WORKER_LIFETIME);
+                }
+                slots_[slot].pid = spawn(slot, nullptr);
+            }
+        }
+    }
+
+    /**
+     * 滚动重启：逐个替换，新进程就绪后旧进程才退出
+     */
+    void rollingRestart() {
+        LOG_INFO << "Supervisor: rolling restart";
+        for (size_t slot = 0; slot < slots_.size(); slot++) {
+            pid_t old = slots_[slot].pid;
+            int readyFd = -1;
+            pid_t pid = spawn(slot, &readyFd);
+            if (pid < 0) {
+                return;
+            }
+            if (!waitReady(readyFd)) {
+                LOG_ERROR << "Supervisor: new worker " << slot << " did not become ready, "
+                          << "keeping the old workers";
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                return;
+            }
+
+            slots_[slot].pid = pid;
+            if (old > 0) {
+                kill(old, SIGTERM);
+                waitExit(old);
+            }
+        }
+        LOG_INFO << "Supervisor: rolling restart finished";
+    }
+
+    /**
+     * 通知全部工作进程退出并等待
+     */
+    void shutdown() {
+        LOG_INFO << "Supervisor: shutting down";
+        for (const auto& slot : slots_) {
+            if (slot.pid > 0) {
+                kill(slot.pid, SIGTERM);
+            }
+        }
+        for (const auto& slot : slots_) {
+            if (slot.pid > 0) {
+                waitExit(slot.pid);
+            }
+        }
+    }
+
+    char** argv_;
+    SupervisorConfig cfg_;
+    std::vector<CpuList> groups_;
+    std::vector<Slot> slots_;
+    std::string exe_;
+    sigset_t signals_;
+};
+
+} // namespace
+
+bool ProcessSupervisor::isSupervisor(const Json::Value& config) {
+    return multiProcessConfig(config).get("enabled", false).asBool() && !std::getenv(ENV_INDEX);
+}
+
+int ProcessSupervisor::run(char* argv[], const Json::Value& config) {
+    Supervisor supervisor(argv, config);
+    return supervisor.run();
+}
+
+void ProcessSupervisor::configureWorker(Json::Value& config) {
+    const char* index = std::getenv(ENV_INDEX);
+    if (!index) {
+        return;
+    }
+
+    const auto& c = multiProcessConfig(config);
+    int workers = std::max(1, std::atoi(std::getenv(ENV_COUNT) ? std::getenv(ENV_COUNT) : "1"));
+    CpuList cpus = parseCpuList(std::getenv(ENV_CPUS) ? std::getenv(ENV_CPUS) : "");
+
+    // 各工作进程监听同一端口
+    config["app"]["reuse_port"] = true;
+
+    std::string threads = c.get("threads_per_worker", "auto").asString();
+    config["app"]["number_of_threads"] = threads == "auto"
+        ? std::max(1, static_cast<int>(cpus.size()))
+        : std::max(1, std::atoi(threads.c_str()));
+
+    // 数据库连接总数不随进程数倍增
+    std::string connections = c.get("db_connections_per_worker", "auto").asString();
+    for (auto& db : config["db_clients"]) {
+        int total = db.get("connection_number", 1).asInt();
+        db["connection_number"] = connections == "auto"
+            ? std::max(1, (total + workers - 1) / workers)
+            : std::max(1, std::atoi(connections.c_str()));
+    }
+
+    // 登录限流按进程计数，连接由内核分散到各进程：每个进程分到总额度的 1/N（至少 1）
+    auto& loginLimit = config["custom_config"]["login_rate_limit"];
+    auto splitLimit = [&loginLimit, workers](const char* key, int defaultLimit) {
+        loginLimit[key] = std::max(1, loginLimit.get(key, defaultLimit).asInt() / workers);
+    };
+    splitLimit("per_ip", 20);
+    splitLimit("per_username", 5);
+}
+
+int ProcessSupervisor::workerIndex() {
+    const char* index = std::getenv(ENV_INDEX);
+    return index ? std::atoi(index) : 0;
+}
+
+void ProcessSupervisor::workerStarted() {
+    const char* index = std::getenv(ENV_INDEX);
+    if (!index) {
+        return;
+    }
+
+    CpuList cpus = parseCpuList(std::getenv(ENV_CPUS) ? std::getenv(ENV_CPUS) : "");
+    bool pinThreads = drogon::app().getCustomConfig()["multi_process"].get("pin_threads", true).asBool();
+    if (pinThreads && !cpus.empty()) {
+        // 每个IO线程绑定到组内的一个核（线程多于核时轮流共用）
+        for (size_t i = 0; i < drogon::app().getThreadNum(); i++) {
+            int cpu = cpus[i % cpus.size()];
+            drogon::app().getIOLoop(i)->queueInLoop([cpu]() {
+                cpu_set_t set = toCpuSet(CpuList{cpu});
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            });
+        }
+    }
+    LOG_INFO << "Worker " << index << " started, pid " << getpid() << ", cpus " << formatCpuList(cpus);
+
+    // 通知监管进程已就绪（只在滚动重启时等待）
+    if (const char* fd = std::getenv(ENV_READY_FD)) {
+        int readyFd = std::atoi(fd);
+        char byte = 1;
+        if (write(readyFd, &byte, 1) != 1) {
+            LOG_WARN << "Worker " << index << ": ready notification failed";
+        }
+        close(readyFd);
+        unsetenv(ENV_READY_FD);
+    }
+}
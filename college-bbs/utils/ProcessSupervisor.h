@@ -0,0 +1,64 @@
+#pragma once
+
+#include <json/json.h>
+
+/**
+ * 多进程模式（SO_REUSEPORT）
+ *
+ * 单个进程的IO线程数固定（config.json 中 number_of_threads），核数多的机器上
+ * 事件循环会先成为瓶颈。多进程模式下主进程只做监管：按CPU核或NUMA节点启动多个工作进程，
+ * 工作进程各自监听同一端口（SO_REUSEPORT，由内核分配连接），IO线程绑定到分配的核上
+ *
+ * 工作进程：
+ * 1. 由监管进程 fork + exec 当前可执行文件启动，参数相同，通过环境变量区分
+ *    （BBS_WORKER_INDEX / BBS_WORKER_COUNT / BBS_WORKER_CPUS / BBS_READY_FD）
+ * 2. 启动前按分组设置进程的CPU亲和性；启动后每个IO线程绑定到组内的一个核
+ * 3. IO线程数和数据库连接池大小按进程数重新计算，避免总连接数随进程数倍增
+ * 4. 开始监听后通过管道通知监管进程"已就绪"
+ *
+ * 监管进程：
+ * - 工作进程异常退出时原位重启
+ * - SIGTERM/SIGINT：通知全部工作进程退出（Drogon收到SIGTERM后处理完当前请求再退出），
+ *   超时仍未退出的强制结束
+ * - SIGHUP：滚动重启，逐个启动新进程，新进程就绪后再让对应的旧进程退出，
+ *   期间端口始终有进程在监听（重新读取配置文件和可执行文件，可用于发布新版本）
+ *
+ * 配置（custom_config.multi_process，只支持JSON配置文件）：
+ * - enabled: 是否启用（默认关闭，单进程运行）
+ * - workers: "auto"=每个核一个进程；"numa"=每个NUMA节点一个进程；或进程数
+ * - threads_per_worker: "auto"=分到的核数；或线程数
+ * - db_connections_per_worker: "auto"=db_clients 中的 connection_number 按进程数均分（向上取整）；或连接数
+ * - pin_threads: 是否绑定CPU
+ * - startup_timeout_seconds: 滚动重启时等待新进程就绪的时间
+ * - shutdown_timeout_seconds: 等待工作进程退出的时间，超时后强制结束
+ */
+class ProcessSupervisor {
+public:
+    /**
+     * 当前进程是否应作为监管进程运行（启用了多进程模式且不是工作进程）
+     */
+    static bool isSupervisor(const Json::Value& config);
+
+    /**
+     * 运行监管进程，直到收到退出信号
+     * 必须在创建任何线程之前调用（即加载Drogon配置之前）
+     * @return 进程退出码
+     */
+    static int run(char* argv[], const Json::Value& config);
+
+    /**
+     * 工作进程：按分配的核数调整配置（IO线程数、数据库连接数、开启 reuse_port）
+     * 非工作进程时不做修改
+     */
+    static void configureWorker(Json::Value& config);
+
+    /**
+     * 工作进程的序号（从0开始）；不是工作进程时为0
+     */
+    static int workerIndex();
+
+    /**
+     * 工作进程：框架启动后调用，把IO线程绑定到核上并通知监管进程已就绪
+     */
+    static void workerStarted();
+};
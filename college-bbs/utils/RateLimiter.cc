@@ -0,0 +1,197 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+RateLimiter::RateLimiter(const Options& options)
+    : options_(options), epoch_(Clock::now()) {
+    options_.windowSeconds = std::max(0.001, options_.windowSeconds);
+    options_.sketchWidth = std::max<size_t>(1, options_.sketchWidth);
+    options_.sketchDepth = std::max<size_t>(1, std::min<size_t>(8, options_.sketchDepth));
+
+    if (options_.mode == Mode::EXACT) {
+        for (size_t i = 0; i < SHARD_COUNT; i++) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    } else {
+        size_t size = options_.sketchWidth * options_.sketchDepth;
+        for (auto& sketch : sketches_) {
+            sketch.counters.reset(new std::atomic<uint32_t>[size]());
+        }
+    }
+}
+
+int64_t RateLimiter::currentWindow(double& elapsedFraction) const {
+    double elapsed = std::chrono::duration<double>(Clock::now() - epoch_).count() / options_.windowSeconds;
+    double whole = std::floor(elapsed);
+    elapsedFraction = elapsed - whole;
+    // 窗口编号从1开始，0表示未使用
+    return static_cast<int64_t>(whole) + 1;
+}
+
+int RateLimiter::retryAfterSeconds() const {
+    double elapsedFraction;
+    currentWindow(elapsedFraction);
+    return std::max(1, static_cast<int>(std::ceil((1.0 - elapsedFraction) * options_.windowSeconds)));
+}
+
+bool RateLimiter::allow(const std::string& key) {
+    double elapsedFraction;
+    int64_t windowId = currentWindow(elapsedFraction);
+
+    if (options_.mode == Mode::EXACT) {
+        return allowExact(key, windowId, elapsedFraction);
+    }
+    return allowSketch(key, windowId, elapsedFraction);
+}
+
+void RateLimiter::release(const std::string& key) {
+    double elapsedFraction;
+    int64_t windowId = currentWindow(elapsedFraction);
+
+    if (options_.mode == Mode::EXACT) {
+        releaseExact(key, windowId);
+    } else {
+        releaseSketch(key, windowId);
+    }
+}
+
+bool RateLimiter::allowExact(const std::string& key, int64_t windowId, double elapsedFraction) {
+    auto& shard = *shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+    size_t shardCapacity = std::max<size_t>(1, options_.maxKeys / SHARD_COUNT);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.windows.find(key);
+    if (it == shard.windows.end()) {
+        if (shard.windows.size() >= shardCapacity) {
+            // 先清理两个窗口内没有请求的key
+            for (auto sweep = shard.windows.begin(); sweep != shard.windows.end();) {
+                if (sweep->second.windowId < windowId - 1) {
+                    sweep = shard.windows.erase(sweep);
+                } else {
+                    ++sweep;
+                }
+            }
+            // 仍然已满时任意淘汰一个，保证新key也能被计数
+            if (shard.windows.size() >= shardCapacity) {
+                shard.windows.erase(shard.windows.begin());
+            }
+        }
+        it = shard.windows.emplace(key, Window{}).first;
+    }
+
+    auto& window = it->second;
+    if (window.windowId != windowId) {
+        window.previous = window.windowId == windowId - 1 ? window.current : 0;
+        window.current = 0;
+        window.windowId = windowId;
+    }
+
+    double estimated = window.previous * (1.0 - elapsedFraction) + window.current;
+    if (estimated + 1 > options_.limit) {
+        return false;
+    }
+    window.current++;
+    return true;
+}
+
+void RateLimiter::releaseExact(const std::string& key, int64_t windowId) {
+    auto& shard = *shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.windows.find(key);
+    if (it == shard.windows.end() || it->second.windowId < windowId - 1) {
+        return;
+    }
+
+    // 计数可能在上一窗口（尚未滚动时仍记在 current 中）
+    auto& window = it->second;
+    if (window.current > 0) {
+        window.current--;
+    } else if (window.previous > 0) {
+        window.previous--;
+    }
+}
+
+void RateLimiter::hashKey(const std::string& key, uint64_t* hashes) const {
+    // 双重哈希：h_i = h1 + i * h2
+    uint64_t h1 = std::hash<std::string>{}(key);
+    uint64_t h2 = (h1 ^ (h1 >> 33)) * 0xff51afd7ed558ccdULL;
+    h2 = (h2 ^ (h2 >> 33)) | 1;
+    for (size_t row = 0; row < options_.sketchDepth; row++) {
+        hashes[row] = row * options_.sketchWidth + (h1 + row * h2) % options_.sketchWidth;
+    }
+}
+
+RateLimiter::Sketch* RateLimiter::sketchFor(int64_t windowId, bool create) {
+    auto& sketch = sketches_[windowId & 1];
+    if (sketch.windowId.load(std::memory_order_acquire) == windowId) {
+        return &sketch;
+    }
+    if (!create) {
+        return nullptr;
+    }
+
+    // 进入新窗口：清零并复用两个窗口之前的那一代
+    std::lock_guard<std::mutex> lock(rotateMutex_);
+    if (sketch.windowId.load(std::memory_order_relaxed) != windowId) {
+        size_t size = options_.sketchWidth * options_.sketchDepth;
+        for (size_t i = 0; i < size; i++) {
+            sketch.counters[i].store(0, std::memory_order_relaxed);
+        }
+        sketch.windowId.store(windowId, std::memory_order_release);
+    }
+    return &sketch;
+}
+
+uint32_t RateLimiter::estimate(const Sketch& sketch, const uint64_t* hashes) const {
+    uint32_t result = UINT32_MAX;
+    for (size_t row = 0; row < options_.sketchDepth; row++) {
+        result = std::min(result, sketch.counters[hashes[row]].load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+bool RateLimiter::allowSketch(const std::string& key, int64_t windowId, double elapsedFraction) {
+    uint64_t hashes[8];
+    hashKey(key, hashes);
+
+    auto* current = sketchFor(windowId, true);
+    auto* previous = sketchFor(windowId - 1, false);
+
+    double estimated = estimate(*current, hashes);
+    if (previous) {
+        estimated += estimate(*previous, hashes) * (1.0 - elapsedFraction);
+    }
+    if (estimated + 1 > options_.limit) {
+        return false;
+    }
+
+    for (size_t row = 0; row < options_.sketchDepth; row++) {
+        current->counters[hashes[row]].fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void RateLimiter::releaseSketch(const std::string& key, int64_t windowId) {
+    uint64_t hashes[8];
+    hashKey(key, hashes);
+
+    auto* sketch = sketchFor(windowId, false);
+    if (!sketch || estimate(*sketch, hashes) == 0) {
+        sketch = sketchFor(windowId - 1, false);
+    }
+    if (!sketch) {
+        return;
+    }
+
+    // 各行分别减1（不减到0以下，避免与其他key共用的计数器下溢）
+    for (size_t row = 0; row < options_.sketchDepth; row++) {
+        auto& counter = sketch->counters[hashes[row]];
+        uint32_t value = counter.load(std::memory_order_relaxed);
+        while (value > 0 &&
+               !counter.compare_exchange_weak(value, value - 1, std::memory_order_relaxed)) {
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 内存滑动窗口限流器
+ *
+ * 按key（如IP、用户名）统计最近一个窗口内的请求数，超过上限时拒绝。
+ * 滑动窗口用"上一窗口计数 × 剩余比例 + 当前窗口计数"近似，
+ * 每个key只需两个计数器
+ *
+ * 两种计数模式：
+ * - exact: 按key精确计数，分片哈希表+分片锁，key数量有上限（超出时淘汰过期key）
+ * - sketch: Count-Min Sketch 近似计数，内存固定（depth × width 个计数器），
+ *           只会高估不会低估，适合key数量不可控的场景（如大量伪造IP）
+ */
+class RateLimiter {
+public:
+    enum class Mode {
+        EXACT,
+        SKETCH
+    };
+
+    struct Options {
+        Mode mode = Mode::EXACT;
+        uint32_t limit = 10;            // 每个窗口允许的请求数
+        double windowSeconds = 60;      // 窗口长度
+        size_t maxKeys = 100000;        // exact模式最多跟踪的key数量
+        size_t sketchWidth = 4096;      // sketch模式每行计数器数
+        size_t sketchDepth = 4;         // sketch模式行数（哈希函数个数）
+    };
+
+    explicit RateLimiter(const Options& options);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * 记录一次请求并判断是否允许
+     * @return true=允许，false=超出限制（被拒绝的请求不计数）
+     */
+    bool allow(const std::string& key);
+
+    /**
+     * 撤销一次已允许的请求计数（如登录成功后不再计入失败尝试）
+     * 只撤销当前或上一窗口内的计数，计数已为0时忽略
+     */
+    void release(const std::string& key);
+
+    /**
+     * 建议客户端重试的等待时间（秒，到当前窗口结束）
+     */
+    int retryAfterSeconds() const;
+
+    const Options& options() const { return options_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // exact模式下单个key的计数
+    struct Window {
+        int64_t windowId = 0;
+        uint32_t current = 0;
+        uint32_t previous = 0;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Window> windows;
+    };
+
+    // sketch模式下的一代计数（对应一个窗口）
+    struct Sketch {
+        std::atomic<int64_t> windowId{0};
+        std::unique_ptr<std::atomic<uint32_t>[]> counters;
+    };
+
+    static const size_t SHARD_COUNT = 16;
+
+    Options options_;
+    Clock::time_point epoch_;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // 两代sketch交替使用：windowId为偶数的窗口用0，奇数用1
+    Sketch sketches_[2];
+    std::mutex rotateMutex_;
+
+    /**
+     * 当前窗口编号和在窗口内已经过的比例
+     */
+    int64_t currentWindow(double& elapsedFraction) const;
+
+    bool allowExact(const std::string& key, int64_t windowId, double elapsedFraction);
+    bool allowSketch(const std::string& key, int64_t windowId, double elapsedFraction);
+    void releaseExact(const std::string& key, int64_t windowId);
+    void releaseSketch(const std::string& key, int64_t windowId);
+
+    /**
+     * 取得某个窗口对应的sketch（必要时清零复用）
+     * @return 窗口已过期（早于上一窗口）时返回nullptr
+     */
+    Sketch* sketchFor(int64_t windowId, bool create);
+
+    uint32_t estimate(const Sketch& sketch, const uint64_t* hashes) const;
+    void hashKey(const std::string& key, uint64_t* hashes) const;
+};
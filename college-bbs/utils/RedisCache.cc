@@ -0,0 +1,278 @@
+#include "RedisCache.h"
+#include <drogon/drogon.h>
+#include <drogon/nosql/RedisClient.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using namespace drogon::nosql;
+
+namespace {
+
+struct CacheConfig {
+    bool enabled;
+    std::string client;
+    std::string keyPrefix;
+    std::chrono::milliseconds postTtl;
+    std::chrono::milliseconds profileTtl;
+};
+
+const CacheConfig& config() {
+    static const CacheConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["redis_cache"];
+        CacheConfig result;
+        result.enabled = c.get("enabled", false).asBool();
+        result.client = c.get("client", "default").asString();
+        result.keyPrefix = c.get("key_prefix", "bbs:").asString();
+        result.postTtl = std::chrono::milliseconds(std::max<int64_t>(1, c.get("post_ttl_ms", 2000).asInt64()));
+        result.profileTtl = std::chrono::milliseconds(std::max<int64_t>(1, c.get("profile_ttl_ms", 10000).asInt64()));
+        return result;
+    }();
+    return cfg;
+}
+
+std::atomic<uint64_t> hitCount{0};
+std::atomic<uint64_t> missCount{0};
+std::atomic<uint64_t> errorCount{0};
+
+// 订阅连接（进程内共用一个）
+std::mutex subscriberMutex;
+std::shared_ptr<RedisSubscriber> subscriber;
+
+RedisClientPtr client() {
+    return drogon::app().getRedisClient(config().client);
+}
+
+std::string prefixed(const std::string& key) {
+    return config().keyPrefix + key;
+}
+
+void logError(const char* command, const RedisException& e) {
+    LOG_WARN << "Redis " << command << " error: " << e.what();
+}
+
+using MgetArgs = std::array<const char*, RedisCache::MAX_KEYS_PER_MGET>;
+
+/**
+ * 以 "MGET %s %s ..." 为格式串发出命令，每个键作为单独的参数（不拼入格式串，键中的 % 和空格不影响解析）
+ * 参数个数固定为 MAX_KEYS_PER_MGET，格式串中占位符之后多余的参数不会被读取
+ */
+template <size_t... I>
+void execMget(RedisResultCallback&& callback, RedisExceptionCallback&& errorCallback,
+              const std::string& format, const MgetArgs& args, std::index_sequence<I...>) {
+    client()->execCommandAsync(std::move(callback), std::move(errorCallback), format, args[I]...);
+}
+
+/**
+ * MGET一批键（不超过 MAX_KEYS_PER_MGET 个）
+ */
+void mgetChunk(const std::vector<std::string>& keys, size_t begin, size_t end,
+               std::function<void(size_t, std::vector<RedisCache::Value>&&)>&& callback) {
+    std::string format = "MGET";
+    std::vector<std::string> prefixedKeys;
+    prefixedKeys.reserve(end - begin);
+    MgetArgs args;
+    args.fill("");
+    for (size_t i = begin; i < end; i++) {
+        format += " %s";
+        prefixedKeys.push_back(prefixed(keys[i]));
+        args[i - begin] = prefixedKeys.back().c_str();
+    }
+
+    size_t count = end - begin;
+    auto shared = std::make_shared<std::function<void(size_t, std::vector<RedisCache::Value>&&)>>(
+        std::move(callback));
+    execMget(
+        [shared, begin, count](const RedisResult& r) {
+            std::vector<RedisCache::Value> values(count);
+            auto items = r.asArray();
+            for (size_t i = 0; i < count && i < items.size(); i++) {
+                if (!items[i].isNil()) {
+                    values[i] = items[i].asString();
+                }
+            }
+            (*shared)(begin, std::move(values));
+        },
+        [shared, begin, count](const RedisException& e) {
+            logError("MGET", e);
+            errorCount.fetch_add(count, std::memory_order_relaxed);
+            (*shared)(begin, std::vector<RedisCache::Value>(count));
+        },
+        format, args, std::make_index_sequence<RedisCache::MAX_KEYS_PER_MGET>());
+}
+
+} // namespace
+
+bool RedisCache::enabled() {
+    return config().enabled;
+}
+
+std::chrono::milliseconds RedisCache::postTtl() {
+    return config().postTtl;
+}
+
+std::chrono::milliseconds RedisCache::profileTtl() {
+    return config().profileTtl;
+}
+
+void RedisCache::get(const std::string& key, ValueCallback&& callback) {
+    if (!enabled()) {
+        callback(std::nullopt);
+        return;
+    }
+
+    auto shared = std::make_shared<ValueCallback>(std::move(callback));
+    client()->execCommandAsync(
+        [shared](const RedisResult& r) {
+            if (r.isNil()) {
+                missCount.fetch_add(1, std::memory_order_relaxed);
+                (*shared)(std::nullopt);
+                return;
+            }
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            (*shared)(r.asString());
+        },
+        [shared](const RedisException& e) {
+            logError("GET", e);
+            errorCount.fetch_add(1, std::memory_order_relaxed);
+            (*shared)(std::nullopt);
+        },
+        "GET %s", prefixed(key).c_str());
+}
+
+void RedisCache::mget(const std::vector<std::string>& keys, ValuesCallback&& callback) {
+    if (!enabled() || keys.empty()) {
+        callback(std::vector<Value>(keys.size()));
+        return;
+    }
+
+    struct MgetState {
+        std::mutex mutex;
+        std::vector<Value> values;
+        size_t pending;
+        ValuesCallback callback;
+    };
+    auto state = std::make_shared<MgetState>();
+    state->values.resize(keys.size());
+    state->pending = (keys.size() + MAX_KEYS_PER_MGET - 1) / MAX_KEYS_PER_MGET;
+    state->callback = std::move(callback);
+
+    // 各批命令连续发出，在连接上流水线执行
+    for (size_t begin = 0; begin < keys.size(); begin += MAX_KEYS_PER_MGET) {
+        size_t end = std::min(keys.size(), begin + MAX_KEYS_PER_MGET);
+        mgetChunk(keys, begin, end, [state](size_t offset, std::vector<Value>&& values) {
+            size_t found = 0;
+            bool done;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                for (size_t i = 0; i < values.size(); i++) {
+                    if (values[i]) {
+                        found++;
+                        state->values[offset + i] = std::move(values[i]);
+                    }
+                }
+                done = --state->pending == 0;
+            }
+            hitCount.fetch_add(found, std::memory_order_relaxed);
+            missCount.fetch_add(values.size() - found, std::memory_order_relaxed);
+            if (done) {
+                state->callback(state->values);
+            }
+        });
+    }
+}
+
+void RedisCache::set(const std::string& key, const std::string& value, std::chrono::milliseconds ttl) {
+    if (!enabled()) {
+        return;
+    }
+
+    auto onResult = [](const RedisResult&) {};
+    auto onError = [](const RedisException& e) {
+        logError("SET", e);
+        errorCount.fetch_add(1, std::memory_order_relaxed);
+    };
+    if (ttl.count() > 0) {
+        client()->execCommandAsync(onResult, onError, "SET %s %b PX %lld",
+                                   prefixed(key).c_str(), value.data(), value.size(),
+                                   static_cast<long long>(ttl.count()));
+    } else {
+        client()->execCommandAsync(onResult, onError, "SET %s %b",
+                                   prefixed(key).c_str(), value.data(), value.size());
+    }
+}
+
+void RedisCache::del(const std::string& key) {
+    if (!enabled()) {
+        return;
+    }
+
+    client()->execCommandAsync(
+        [](const RedisResult&) {},
+        [](const RedisException& e) {
+            logError("DEL", e);
+            errorCount.fetch_add(1, std::memory_order_relaxed);
+        },
+        "DEL %s", prefixed(key).c_str());
+}
+
+void RedisCache::incr(const std::string& key, std::function<void(int64_t)>&& callback) {
+    if (!enabled()) {
+        return;
+    }
+
+    auto shared = std::make_shared<std::function<void(int64_t)>>(std::move(callback));
+    client()->execCommandAsync(
+        [shared](const RedisResult& r) {
+            (*shared)(r.asInteger());
+        },
+        [](const RedisException& e) {
+            logError("INCR", e);
+            errorCount.fetch_add(1, std::memory_order_relaxed);
+        },
+        "INCR %s", prefixed(key).c_str());
+}
+
+void RedisCache::publish(const std::string& channel, const std::string& message) {
+    if (!enabled()) {
+        return;
+    }
+
+    client()->execCommandAsync(
+        [](const RedisResult&) {},
+        [](const RedisException& e) {
+            logError("PUBLISH", e);
+            errorCount.fetch_add(1, std::memory_order_relaxed);
+        },
+        "PUBLISH %s %b", prefixed(channel).c_str(), message.data(), message.size());
+}
+
+void RedisCache::subscribe(const std::string& channel, MessageHandler&& handler) {
+    if (!enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(subscriberMutex);
+    if (!subscriber) {
+        subscriber = client()->newSubscriber();
+    }
+    subscriber->subscribe(prefixed(channel),
+                          [handler = std::move(handler)](const std::string&, const std::string& message) {
+                              handler(message);
+                          });
+}
+
+uint64_t RedisCache::hits() {
+    return hitCount.load(std::memory_order_relaxed);
+}
+
+uint64_t RedisCache::misses() {
+    return missCount.load(std::memory_order_relaxed);
+}
+
+uint64_t RedisCache::errors() {
+    return errorCount.load(std::memory_order_relaxed);
+}
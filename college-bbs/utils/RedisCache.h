@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * 进程间共享的二级缓存（Redis）
+ *
+ * 多个进程部署在nginx之后时，各进程的内存缓存（一级缓存）互不相通，
+ * 每个进程都要单独查询MySQL。二级缓存放在Redis中，一级缓存未命中时先查这里，
+ * 还未命中才查数据库，查到后写回Redis供其他进程使用
+ *
+ * 设计要点：
+ * 1. 基于Drogon的Redis客户端（config中的 redis_clients），只用异步接口；
+ *    同一连接上连续发出的命令自动流水线化
+ * 2. 批量读取用MGET（每条命令最多 MAX_KEYS_PER_MGET 个键，多条命令流水线发出）
+ * 3. 失效消息通过发布/订阅广播，各进程收到后删除自己的一级缓存条目
+ * 4. Redis不可用时一律视为未命中（读）或忽略（写），不影响请求
+ * 5. 键统一加前缀（key_prefix），多个环境可以共用一个Redis
+ *
+ * 配置（custom_config.redis_cache）：
+ * - enabled: 是否启用（默认关闭；启用时需同时配置 redis_clients）
+ * - client: 使用的Redis客户端名称
+ * - key_prefix: 键前缀
+ * - post_ttl_ms: 帖子列表页和帖子详情的过期时间
+ * - profile_ttl_ms: 用户信息的过期时间
+ */
+class RedisCache {
+public:
+    using Value = std::optional<std::string>;
+    using ValueCallback = std::function<void(const Value&)>;
+    using ValuesCallback = std::function<void(const std::vector<Value>&)>;
+    using MessageHandler = std::function<void(const std::string& message)>;
+
+    static const size_t MAX_KEYS_PER_MGET = 100;
+
+    /**
+     * 是否启用
+     */
+    static bool enabled();
+
+    /**
+     * 帖子列表页和帖子详情的过期时间
+     */
+    static std::chrono::milliseconds postTtl();
+
+    /**
+     * 用户信息的过期时间
+     */
+    static std::chrono::milliseconds profileTtl();
+
+    /**
+     * 读取一个键（不存在或出错时为空）
+     * @param key 不含前缀的键
+     */
+    static void get(const std::string& key, ValueCallback&& callback);
+
+    /**
+     * 批量读取，结果与 keys 一一对应
+     */
+    static void mget(const std::vector<std::string>& keys, ValuesCallback&& callback);
+
+    /**
+     * 写入一个键
+     * @param ttl 过期时间，0表示不过期
+     */
+    static void set(const std::string& key, const std::string& value,
+                    std::chrono::milliseconds ttl = std::chrono::milliseconds(0));
+
+    /**
+     * 删除一个键
+     */
+    static void del(const std::string& key);
+
+    /**
+     * 自增一个键
+     * @param callback 参数为自增后的值，出错时不调用
+     */
+    static void incr(const std::string& key, std::function<void(int64_t)>&& callback);
+
+    /**
+     * 向频道发布消息
+     * @param channel 不含前缀的频道名
+     */
+    static void publish(const std::string& channel, const std::string& message);
+
+    /**
+     * 订阅频道（启动时调用；本进程发布的消息也会收到）
+     */
+    static void subscribe(const std::string& channel, MessageHandler&& handler);
+
+    /**
+     * 命中/未命中/出错次数（按键计）
+     */
+    static uint64_t hits();
+    static uint64_t misses();
+    static uint64_t errors();
+};
@@ -0,0 +1,298 @@
+#include "ReplyWriteCoalescer.h"
+#include "AdmissionController.h"
+#include "ErrorLogger.h"
+#include "PostResponseCache.h"
+#include "PostSummaryStore.h"
+#include "SqlStatements.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace drogon::orm;
+
+namespace {
+
+struct PendingReply {
+    RequestContextPtr ctx;
+    int post_id;
+    int user_id;
+    std::string content;
+    ReplyWriteCoalescer::DoneCallback callback;
+    ReplyWriteCoalescer::ErrorCallback errorCallback;
+};
+
+using Batch = std::vector<PendingReply>;
+using BatchPtr = std::shared_ptr<Batch>;
+
+struct CoalescerConfig {
+    bool enabled;
+    double window;     // 秒
+    size_t maxBatch;
+};
+
+const CoalescerConfig& config() {
+    static const CoalescerConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["reply_coalescer"];
+        CoalescerConfig result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.window = c.get("window_ms", 2).asDouble() / 1000.0;
+        result.maxBatch = std::max<size_t>(1, c.get("max_batch", 128).asUInt64());
+        return result;
+    }();
+    return cfg;
+}
+
+/**
+ * 把一次批量语句的耗时计入同批的每个请求
+ */
+void recordBatchQuery(const BatchPtr& batch, const sql::StatementBase& statement,
+                      std::chrono::steady_clock::time_point start, bool ok) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    for (const auto& item : *batch) {
+        if (item.ctx) {
+            item.ctx->recordQuery(statement.name(), start, micros, ok);
+        }
+    }
+}
+
+std::mutex pendingMutex;
+Batch pending;
+bool flushScheduled = false;
+
+// 自增ID的步长（@@auto_increment_increment），启动时确认；0=未确认或不支持，逐条写入
+std::atomic<int64_t> autoIncrementStep{0};
+
+/**
+ * 单条写入：每条回复一个事务（未启用合并、不能批量写入或批量失败时使用）
+ */
+void insertSingle(PendingReply item) {
+    auto dbClient = drogon::app().getDbClient();
+    auto transPtr = dbClient->newTransaction();
+    auto reply = std::make_shared<PendingReply>(std::move(item));
+
+    // 插入回复
+    sql::execAsync(
+        reply->ctx, transPtr, sql::REPLY_INSERT,
+        [reply, transPtr](const Result& r) {
+            auto insert_id = static_cast<int64_t>(r.insertId());
+
+            // 更新帖子的回复数 +1
+            sql::execAsync(
+                reply->ctx, transPtr, sql::POST_INCREMENT_REPLY,
+                [reply, insert_id, transPtr](const Result& r) {
+                    // 提交事务
+                    transPtr->commit([reply, insert_id]() {
+                        PostSummaryStore::addReplyCount(reply->post_id, 1);
+                        PostResponseCache::invalidateDetail(reply->post_id);
+                        reply->callback(insert_id);
+                    });
+                },
+                [reply, transPtr](const DrogonDbException& e) {
+                    ErrorLogger::logBackgroundError("increment reply count", e);
+                    // 回滚事务
+                    transPtr->rollback();
+                    reply->errorCallback(e);
+                },
+                reply->post_id
+            );
+        },
+        [reply, transPtr](const DrogonDbException& e) {
+            ErrorLogger::logBackgroundError("insert reply", e);
+            // 回滚事务
+            transPtr->rollback();
+            reply->errorCallback(e);
+        },
+        reply->post_id, reply->user_id, reply->content
+    );
+}
+
+/**
+ * 逐条写入（批量写入失败时重试）
+ */
+void writeSingly(const BatchPtr& batch) {
+    for (auto& item : *batch) {
+        insertSingle(std::move(item));
+    }
+}
+
+/**
+ * 在事务中依次更新各帖子的回复数，全部成功后提交
+ */
+void updateCounts(const BatchPtr& batch,
+                  const TransactionPtr& transPtr,
+                  const std::shared_ptr<std::map<int, int>>& counts,
+                  std::map<int, int>::const_iterator it,
+                  int64_t first_id,
+                  int64_t step) {
+    if (it == counts->end()) {
+        // 提交事务，按插入顺序分配回复ID
+        transPtr->commit([batch, counts, first_id, step]() {
+            for (const auto& count : *counts) {
+                PostSummaryStore::addReplyCount(count.first, count.second);
+                PostResponseCache::invalidateDetail(count.first);
+            }
+            int64_t reply_id = first_id;
+            for (auto& item : *batch) {
+                item.callback(reply_id);
+                reply_id += step;
+            }
+        });
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    sql::execAsync(
+        nullptr, transPtr, sql::POST_ADD_REPLIES,
+        [batch, transPtr, counts, it, first_id, step, start](const Result& r) {
+            recordBatchQuery(batch, sql::POST_ADD_REPLIES, start, true);
+            updateCounts(batch, transPtr, counts, std::next(it), first_id, step);
+        },
+        [batch, transPtr, start](const DrogonDbException& e) {
+            recordBatchQuery(batch, sql::POST_ADD_REPLIES, start, false);
+            ErrorLogger::logBackgroundError("batch update reply count", e);
+            transPtr->rollback();
+            writeSingly(batch);
+        },
+        it->second, it->first
+    );
+}
+
+/**
+ * 批量写入一组回复
+ */
+void writeBatch(const BatchPtr& batch) {
+    int64_t step = autoIncrementStep.load(std::memory_order_relaxed);
+    if (batch->size() == 1 || step == 0) {
+        writeSingly(batch);
+        return;
+    }
+
+    auto dbClient = drogon::app().getDbClient();
+    auto transPtr = dbClient->newTransaction();
+
+    // 多行INSERT在InnoDB中一次性分配自增ID（innodb_autoinc_lock_mode 为0或1，见 start()），
+    // insertId() 为第一行的ID，后续行依次加 auto_increment_increment
+    std::string batch_sql = sql::REPLY_INSERT_BATCH.text();
+    for (size_t i = 1; i < batch->size(); i++) {
+        batch_sql += ", (?, ?, ?)";
+    }
+
+    auto counts = std::make_shared<std::map<int, int>>();
+    for (const auto& item : *batch) {
+        (*counts)[item.post_id]++;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AdmissionController::queryStarted();
+    auto binder = *transPtr << batch_sql;
+    for (const auto& item : *batch) {
+        binder << item.post_id << item.user_id << item.content;
+    }
+    binder >> [batch, transPtr, counts, step, start](const Result& r) {
+        AdmissionController::queryFinished(sql::REPLY_INSERT_BATCH.recordSuccess(start));
+        recordBatchQuery(batch, sql::REPLY_INSERT_BATCH, start, true);
+        auto first_id = static_cast<int64_t>(r.insertId());
+        updateCounts(batch, transPtr, counts, counts->cbegin(), first_id, step);
+    };
+    binder >> [batch, transPtr, start](const DrogonDbException& e) {
+        AdmissionController::queryFinished(sql::REPLY_INSERT_BATCH.recordError(start));
+        recordBatchQuery(batch, sql::REPLY_INSERT_BATCH, start, false);
+        ErrorLogger::logBackgroundError("batch insert replies (retrying singly)", e);
+        transPtr->rollback();
+        writeSingly(batch);
+    };
+    binder.exec();
+}
+
+/**
+ * 取出当前窗口内的回复并写入
+ */
+void flush() {
+    auto batch = std::make_shared<Batch>();
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        batch->swap(pending);
+        flushScheduled = false;
+    }
+
+    if (!batch->empty()) {
+        writeBatch(batch);
+    }
+}
+
+} // namespace
+
+bool ReplyWriteCoalescer::enabled() {
+    return config().enabled;
+}
+
+void ReplyWriteCoalescer::start(const DbClientPtr& client) {
+    if (!enabled()) {
+        return;
+    }
+
+    // 只在自增ID可按行推算时批量写入：
+    // - innodb_autoinc_lock_mode=2（交错模式）下同一条语句分到的ID可能不连续
+    // - auto_increment_increment>1（多主复制常见）时相邻行的ID相差该步长
+    client->execSqlAsync(
+        "SELECT @@auto_increment_increment AS step, @@innodb_autoinc_lock_mode AS lock_mode",
+        [](const Result& r) {
+            auto step = r[0]["step"].as<int64_t>();
+            auto lockMode = r[0]["lock_mode"].as<int>();
+            if (lockMode > 1 || step < 1) {
+                LOG_WARN << "Reply coalescing disabled: innodb_autoinc_lock_mode=" << lockMode
+                         << ", auto_increment_increment=" << step
+                         << " (batched reply ids need lock mode 0 or 1)";
+                return;
+            }
+            autoIncrementStep.store(step, std::memory_order_relaxed);
+            LOG_INFO << "Reply coalescing enabled, auto_increment_increment=" << step;
+        },
+        [](const DrogonDbException& e) {
+            LOG_WARN << "Reply coalescing disabled, cannot read auto-increment settings: "
+                     << e.base().what();
+        });
+}
+
+void ReplyWriteCoalescer::submit(const RequestContextPtr& ctx,
+                                 int post_id, int user_id, std::string content,
+                                 DoneCallback&& callback,
+                                 ErrorCallback&& errorCallback) {
+    PendingReply item{ctx, post_id, user_id, std::move(content),
+                      std::move(callback), std::move(errorCallback)};
+
+    // 未启用或自增设置不支持批量时直接写入，不等待合并窗口
+    if (!enabled() || autoIncrementStep.load(std::memory_order_relaxed) == 0) {
+        insertSingle(std::move(item));
+        return;
+    }
+
+    BatchPtr full;
+    bool scheduleTimer = false;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.push_back(std::move(item));
+
+        if (pending.size() >= config().maxBatch) {
+            // 达到批量上限，立即写入（已安排的定时器届时会看到空队列）
+            full = std::make_shared<Batch>();
+            full->swap(pending);
+        } else if (!flushScheduled) {
+            flushScheduled = true;
+            scheduleTimer = true;
+        }
+    }
+
+    if (full) {
+        writeBatch(full);
+    } else if (scheduleTimer) {
+        drogon::app().getLoop()->runAfter(config().window, flush);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "RequestContext.h"
+#include <drogon/orm/DbClient.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * 回复写入合并器
+ *
+ * 热门帖子下的回复会集中更新同一行 posts.reply_count，
+ * 每条回复单独开事务时这些事务会在该行上排队等锁
+ *
+ * 合并器在一个很短的时间窗口内（默认2ms）收集回复：
+ * 1. 用一条多行INSERT写入窗口内的全部回复
+ * 2. 每个帖子只执行一次 reply_count = reply_count + n
+ * 3. 提交后按顺序把各自的回复ID回调给每个请求
+ *
+ * 批量写入失败时（如帖子在窗口期内被删除）逐条重试，
+ * 保证一条坏数据不会连累同批的其他回复
+ *
+ * 各行的回复ID由第一行的ID按 auto_increment_increment 推算，
+ * 只在 innodb_autoinc_lock_mode 为0或1时成立；启动时检查，不满足则逐条写入
+ *
+ * 配置（custom_config.reply_coalescer）：
+ * - enabled: 是否启用合并，关闭时每条回复单独开事务
+ * - window_ms: 合并窗口
+ * - max_batch: 单批最多回复数，达到后立即写入
+ */
+class ReplyWriteCoalescer {
+public:
+    using DoneCallback = std::function<void(int64_t reply_id)>;
+    using ErrorCallback = std::function<void(const drogon::orm::DrogonDbException&)>;
+
+    /**
+     * 提交一条回复
+     * 调用前应已确认帖子存在
+     * @param ctx 请求上下文，批量写入的耗时会计入同批每个请求
+     */
+    static void submit(const RequestContextPtr& ctx, int post_id, int user_id, std::string content,
+                       DoneCallback&& callback,
+                       ErrorCallback&& errorCallback);
+
+    /**
+     * 检查数据库的自增设置，确认可以批量写入后才开始合并（启动时调用一次）
+     */
+    static void start(const drogon::orm::DbClientPtr& client);
+
+    /**
+     * 是否启用合并
+     */
+    static bool enabled();
+};
@@ -0,0 +1,65 @@
+#include "RequestContext.h"
+#include <random>
+
+// attributes 中保存上下文的键
+static const char* const CONTEXT_KEY = "request_context";
+
+/**
+ * 生成追踪ID：高24位为线程随机种子，低40位为线程内递增计数
+ * 无锁，且各线程之间基本不会冲突
+ */
+static uint64_t nextTraceId() {
+    thread_local uint64_t prefix = [] {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) & 0xFFFFFF) << 40;
+    }();
+    thread_local uint64_t counter = 0;
+    return prefix | (++counter & 0xFFFFFFFFFFULL);
+}
+
+void RequestContext::recordQuery(const char* statement, Clock::time_point queryStart,
+                                 uint64_t micros, bool ok) {
+    dbMicros.fetch_add(micros, std::memory_order_relaxed);
+    dbQueries.fetch_add(1, std::memory_order_relaxed);
+
+    auto offset = std::chrono::duration_cast<std::chrono::microseconds>(queryStart - start).count();
+
+    std::lock_guard<std::mutex> lock(spansMutex_);
+    if (spans_.size() >= MAX_SPANS) {
+        droppedSpans_++;
+        return;
+    }
+    if (spans_.empty()) {
+        spans_.reserve(8);
+    }
+    spans_.push_back(Span{statement,
+                          static_cast<uint32_t>(offset > 0 ? offset : 0),
+                          static_cast<uint32_t>(micros),
+                          ok});
+}
+
+std::vector<RequestContext::Span> RequestContext::spans(uint32_t& dropped) const {
+    std::lock_guard<std::mutex> lock(spansMutex_);
+    dropped = droppedSpans_;
+    return std::vector<Span>(spans_.begin(), spans_.end());
+}
+
+std::string RequestContext::traceIdHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; i--) {
+        hex[i] = digits[(traceId >> ((15 - i) * 4)) & 0xF];
+    }
+    return hex;
+}
+
+std::shared_ptr<RequestContext> RequestContext::create(const drogon::HttpRequestPtr& req) {
+    auto ctx = std::make_shared<RequestContext>();
+    ctx->traceId = nextTraceId();
+    req->attributes()->insert(CONTEXT_KEY, ctx);
+    return ctx;
+}
+
+std::shared_ptr<RequestContext> RequestContext::get(const drogon::HttpRequestPtr& req) {
+    return req->attributes()->get<std::shared_ptr<RequestContext>>(CONTEXT_KEY);
+}
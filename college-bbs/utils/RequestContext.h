@@ -0,0 +1,106 @@
+#pragma once
+
+#include "ScratchArena.h"
+#include <drogon/HttpRequest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * 请求上下文
+ *
+ * 每个请求在进入路由前创建一份，保存在 request 的 attributes 中，
+ * 控制器在回调链中持有它并传给 sql::execAsync，用于统计：
+ * - 请求开始时间和追踪ID
+ * - 本请求累计的数据库耗时和查询次数
+ * - 每条SQL语句的耗时片段（span），供请求追踪输出
+ *
+ * 另外带一个请求级临时内存池（arena），随上下文释放
+ */
+class RequestContext {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 一条SQL语句的耗时片段
+     */
+    struct Span {
+        const char* name;       // 语句名称（静态字符串）
+        uint32_t startMicros;   // 相对请求开始的偏移
+        uint32_t durationMicros;
+        bool ok;
+    };
+
+    // 单个请求最多记录的片段数，超出的只计数
+    static const size_t MAX_SPANS = 32;
+
+    // 请求开始时间
+    Clock::time_point start = Clock::now();
+
+    // 追踪ID（创建时生成）
+    uint64_t traceId = 0;
+
+    // 本请求的数据库累计耗时（微秒）和查询次数
+    std::atomic<uint64_t> dbMicros{0};
+    std::atomic<uint32_t> dbQueries{0};
+
+    // 请求级临时内存池
+    ScratchArena arena;
+
+    /**
+     * 记录一次数据库查询
+     * @param statement 语句名称（静态字符串）
+     * @param queryStart 查询开始时间
+     * @param micros 查询耗时
+     * @param ok 是否成功
+     */
+    void recordQuery(const char* statement, Clock::time_point queryStart, uint64_t micros, bool ok);
+
+    /**
+     * 取出已记录的片段
+     * @param dropped 输出超出上限未记录的片段数
+     */
+    std::vector<Span> spans(uint32_t& dropped) const;
+
+    /**
+     * 从请求开始到现在的耗时（微秒）
+     */
+    uint64_t elapsedMicros() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    }
+
+    /**
+     * 追踪ID的16位十六进制形式
+     */
+    std::string traceIdHex() const;
+
+    /**
+     * 临时容器使用的内存池：有上下文时为请求内存池，否则为默认堆分配
+     */
+    static std::pmr::memory_resource* memoryResource(const std::shared_ptr<RequestContext>& ctx) {
+        return ctx ? &ctx->arena : std::pmr::get_default_resource();
+    }
+
+    /**
+     * 为请求创建上下文并存入attributes
+     */
+    static std::shared_ptr<RequestContext> create(const drogon::HttpRequestPtr& req);
+
+    /**
+     * 获取请求的上下文（未创建时返回空指针）
+     */
+    static std::shared_ptr<RequestContext> get(const drogon::HttpRequestPtr& req);
+
+private:
+    // 查询回调可能来自不同的数据库线程
+    mutable std::mutex spansMutex_;
+    std::pmr::vector<Span> spans_{&arena};
+    uint32_t droppedSpans_ = 0;
+};
+
+using RequestContextPtr = std::shared_ptr<RequestContext>;
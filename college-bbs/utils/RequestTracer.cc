@@ -0,0 +1,221 @@
+#include "RequestTracer.h"
+#include "Metrics.h"
+#include "RequestContext.h"
+#include <drogon/drogon.h>
+#include <trantor/net/EventLoopThread.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// 每个线程的环形缓冲区容量（2的幂）
+const size_t RING_CAPACITY = 128;
+
+struct TracerConfig {
+    bool enabled;
+    std::string file;
+    uint64_t slowThresholdMicros;
+    double sampleRate;
+    double flushInterval;   // 秒
+};
+
+const TracerConfig& config() {
+    static const TracerConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["tracing"];
+        TracerConfig result;
+        result.enabled = c.get("enabled", false).asBool();
+        result.file = c.get("file", "./logs/trace.jsonl").asString();
+        result.slowThresholdMicros = c.get("slow_threshold_ms", 200).asUInt64() * 1000;
+        result.sampleRate = c.get("sample_rate", 0.0).asDouble();
+        result.flushInterval = c.get("flush_interval_ms", 1000).asDouble() / 1000.0;
+        return result;
+    }();
+    return cfg;
+}
+
+/**
+ * 一条追踪记录（定长，写入环形缓冲区时不分配内存）
+ */
+struct TraceRecord {
+    uint64_t traceId;
+    int64_t wallMicros;       // 请求开始的Unix时间（微秒）
+    char route[96];
+    uint16_t status;
+    uint32_t totalMicros;
+    uint32_t dbMicros;
+    uint32_t spanCount;
+    uint32_t droppedSpans;
+    RequestContext::Span spans[RequestContext::MAX_SPANS];
+};
+
+/**
+ * 单生产者单消费者环形缓冲区
+ * 生产者为所属线程，消费者为写文件线程
+ */
+struct TraceRing {
+    std::array<TraceRecord, RING_CAPACITY> records;
+    std::atomic<size_t> head{0};      // 下一个写入位置（生产者）
+    std::atomic<size_t> tail{0};      // 下一个读取位置（消费者）
+    std::atomic<uint64_t> dropped{0};
+};
+
+std::mutex ringsMutex;
+std::vector<TraceRing*> rings;
+
+TraceRing& localRing() {
+    // 环形缓冲区随进程存在，线程退出后剩余记录仍会被写出
+    thread_local TraceRing* ring = [] {
+        auto* r = new TraceRing();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(r);
+        return r;
+    }();
+    return *ring;
+}
+
+bool shouldSample(uint64_t traceId, uint64_t totalMicros) {
+    if (totalMicros >= config().slowThresholdMicros) {
+        return true;
+    }
+    if (config().sampleRate <= 0) {
+        return false;
+    }
+    // 追踪ID低位是递增计数，先打散再按比例采样
+    uint64_t hash = (traceId * 0x9E3779B97F4A7C15ULL) >> 11;
+    return static_cast<double>(hash) < config().sampleRate * static_cast<double>(1ULL << 53);
+}
+
+void appendEscaped(std::string& out, const char* value) {
+    for (const char* p = value; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            out += '\\';
+        }
+        out += *p;
+    }
+}
+
+void appendRecord(std::string& out, const TraceRecord& record) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"trace_id\":\"%016llx\",\"ts_us\":%lld,\"route\":\"",
+             static_cast<unsigned long long>(record.traceId),
+             static_cast<long long>(record.wallMicros));
+    out += buf;
+    appendEscaped(out, record.route);
+    snprintf(buf, sizeof(buf),
+             "\",\"status\":%u,\"total_us\":%u,\"db_us\":%u,\"dropped_spans\":%u,\"spans\":[",
+             record.status, record.totalMicros, record.dbMicros, record.droppedSpans);
+    out += buf;
+
+    for (uint32_t i = 0; i < record.spanCount; i++) {
+        const auto& span = record.spans[i];
+        out += i == 0 ? "{\"name\":\"" : ",{\"name\":\"";
+        appendEscaped(out, span.name);
+        snprintf(buf, sizeof(buf), "\",\"start_us\":%u,\"dur_us\":%u,\"ok\":%s}",
+                 span.startMicros, span.durationMicros, span.ok ? "true" : "false");
+        out += buf;
+    }
+    out += "]}\n";
+}
+
+/**
+ * 取出所有线程的记录并追加到文件（在写文件线程上执行）
+ */
+void drain(std::ofstream& file) {
+    std::vector<TraceRing*> currentRings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        currentRings = rings;
+    }
+
+    std::string out;
+    uint64_t dropped = 0;
+    for (auto* ring : currentRings) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            appendRecord(out, ring->records[tail % RING_CAPACITY]);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    if (dropped > 0) {
+        LOG_WARN << "Request tracer dropped " << dropped << " records (ring buffer full)";
+    }
+    if (!out.empty()) {
+        file.write(out.data(), out.size());
+        file.flush();
+    }
+}
+
+} // namespace
+
+void RequestTracer::start() {
+    if (!config().enabled) {
+        return;
+    }
+
+    auto file = std::make_shared<std::ofstream>(config().file, std::ios::app | std::ios::binary);
+    if (!file->is_open()) {
+        LOG_ERROR << "Request tracer disabled: cannot open " << config().file;
+        return;
+    }
+
+    // 写文件在独立线程上进行，不占用主循环和IO线程
+    static trantor::EventLoopThread writerThread("TraceWriter");
+    writerThread.run();
+    writerThread.getLoop()->runEvery(config().flushInterval, [file]() {
+        drain(*file);
+    });
+}
+
+void RequestTracer::requestFinished(const drogon::HttpRequestPtr& req,
+                                    const drogon::HttpResponsePtr& resp) {
+    auto ctx = RequestContext::get(req);
+    if (!ctx) {
+        return;
+    }
+
+    resp->addHeader("X-Trace-Id", ctx->traceIdHex());
+
+    if (!config().enabled) {
+        return;
+    }
+
+    auto totalMicros = ctx->elapsedMicros();
+    if (!shouldSample(ctx->traceId, totalMicros)) {
+        return;
+    }
+
+    auto& ring = localRing();
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& record = ring.records[head % RING_CAPACITY];
+    record.traceId = ctx->traceId;
+    record.wallMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count() - static_cast<int64_t>(totalMicros);
+    auto route = Metrics::routeName(req);
+    snprintf(record.route, sizeof(record.route), "%s", route.c_str());
+    record.status = static_cast<uint16_t>(resp->statusCode());
+    record.totalMicros = static_cast<uint32_t>(totalMicros);
+    record.dbMicros = static_cast<uint32_t>(ctx->dbMicros.load(std::memory_order_relaxed));
+
+    uint32_t droppedSpans = 0;
+    auto spans = ctx->spans(droppedSpans);
+    record.spanCount = static_cast<uint32_t>(spans.size());
+    record.droppedSpans = droppedSpans;
+    std::copy(spans.begin(), spans.end(), record.spans);
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+
+/**
+ * 请求追踪
+ *
+ * 请求结束时根据 RequestContext 生成一条追踪记录（路由、状态码、总耗时、
+ * 每条SQL语句的耗时片段），写入当前线程的环形缓冲区；
+ * 后台线程定期取出所有线程的记录，以JSON Lines格式追加到本地文件
+ *
+ * 采样规则：
+ * - 耗时超过 slow_threshold_ms 的请求总是记录
+ * - 其他请求按 sample_rate 随机采样
+ *
+ * 环形缓冲区满时丢弃新记录（只计数），不会阻塞IO线程
+ * 响应头 X-Trace-Id 返回追踪ID，便于按ID在追踪文件中查找
+ *
+ * 配置（custom_config.tracing）：
+ * - enabled: 是否启用
+ * - file: 输出文件
+ * - slow_threshold_ms: 慢请求阈值
+ * - sample_rate: 普通请求采样率（0-1）
+ * - flush_interval_ms: 写文件间隔
+ */
+class RequestTracer {
+public:
+    /**
+     * 启动后台写入线程（启用时）
+     */
+    static void start();
+
+    /**
+     * 请求结束（发送响应前调用）：添加追踪ID响应头，按采样规则记录
+     */
+    static void requestFinished(const drogon::HttpRequestPtr& req,
+                                const drogon::HttpResponsePtr& resp);
+};
@@ -0,0 +1,43 @@
+#include "ResponseCache.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+
+namespace {
+
+std::vector<const ResponseCacheBase*>& registry() {
+    static std::vector<const ResponseCacheBase*> caches;
+    return caches;
+}
+
+ResponseCacheBase::Clock::duration millis(double value) {
+    return std::chrono::duration_cast<ResponseCacheBase::Clock::duration>(
+        std::chrono::duration<double, std::milli>(value));
+}
+
+} // namespace
+
+ResponseCacheBase::ResponseCacheBase(const char* name)
+    : name_(name) {
+    registry().push_back(this);
+}
+
+const ResponseCacheBase::Config& ResponseCacheBase::config() {
+    static const Config cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["response_cache"];
+        Config result;
+        result.enabled = c.get("enabled", true).asBool();
+        double ttl = std::max(0.0, c.get("ttl_ms", 2000.0).asDouble());
+        double refreshAhead = std::min(ttl, std::max(0.0, c.get("refresh_ahead_ms", 1000.0).asDouble()));
+        double maxStale = std::max(ttl, c.get("max_stale_ms", 10000.0).asDouble());
+        result.refreshAhead = millis(refreshAhead);
+        result.ttl = millis(ttl);
+        result.maxStale = millis(maxStale);
+        result.maxEntries = std::max<size_t>(1, c.get("max_entries", 10000).asUInt64());
+        return result;
+    }();
+    return cfg;
+}
+
+const std::vector<const ResponseCacheBase*>& ResponseCacheBase::all() {
+    return registry();
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "SingleFlight.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 读接口的响应缓存（stale-while-revalidate）
+ *
+ * 普通TTL缓存每次过期后，下一个请求要完整地等待一遍多条查询。
+ * 按缓存条目的年龄分为：
+ * - 年龄 < refresh_ahead_ms：直接返回
+ * - refresh_ahead_ms <= 年龄 < max_stale_ms：立即返回旧结果，同时在后台发起一次刷新
+ *   （每个键同一时间只有一次刷新）。ttl_ms 之前算新鲜命中（提前刷新），之后算过期命中
+ * - 年龄 >= max_stale_ms 或不存在：同步加载
+ *
+ * 持续被访问的热点键在过期前就已刷新，不会出现未命中；
+ * 加载和刷新都经过 SingleFlight 合并，同一个键不会并发查询。刷新失败时保留旧条目，
+ * 但不超过 max_stale_ms
+ *
+ * 失效与进行中的读取：失效时记下序号，开始早于失效的读取结果只分发给已在等待的请求，
+ * 不写入缓存；失效之后的请求也不再挂到这些读取上，而是重新查询
+ *
+ * 配置（custom_config.response_cache）：
+ * - enabled: 是否启用（关闭时每次都经 SingleFlight 读取）
+ * - refresh_ahead_ms / ttl_ms / max_stale_ms: 上述三个阈值
+ * - max_entries: 每个缓存的最大条目数，满时先清理超过 max_stale_ms 的条目，仍满则整体清空
+ */
+class ResponseCacheBase {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 命中/未命中统计
+     */
+    struct Stats {
+        std::atomic<uint64_t> freshHits{0};
+        std::atomic<uint64_t> staleHits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> refreshes{0};
+    };
+
+    struct Config {
+        bool enabled;
+        Clock::duration refreshAhead;
+        Clock::duration ttl;
+        Clock::duration maxStale;
+        size_t maxEntries;
+    };
+
+    explicit ResponseCacheBase(const char* name);
+    virtual ~ResponseCacheBase() = default;
+
+    ResponseCacheBase(const ResponseCacheBase&) = delete;
+    ResponseCacheBase& operator=(const ResponseCacheBase&) = delete;
+
+    const char* name() const { return name_; }
+    const Stats& stats() const { return stats_; }
+
+    static const Config& config();
+
+    /**
+     * 全部缓存（用于导出指标）
+     */
+    static const std::vector<const ResponseCacheBase*>& all();
+
+protected:
+    mutable Stats stats_;
+
+private:
+    const char* name_;
+};
+
+/**
+ * 按键缓存读取结果
+ *
+ * 用法：
+ *   static SingleFlight<int, Result> detailFlight("post_detail");
+ *   static ResponseCache<int, Result> detailCache("post_detail", detailFlight, isCacheable);
+ *   detailCache.get(post_id, fetch, callback);   // fetch 与 SingleFlight::run 相同
+ *
+ * @param cacheable 判断结果是否可以缓存（错误结果不缓存）
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ResponseCache : public ResponseCacheBase {
+public:
+    using Flight = SingleFlight<Key, Value, Hash>;
+    using ValuePtr = typename Flight::ValuePtr;
+    using Callback = typename Flight::Callback;
+    using Done = typename Flight::Done;
+
+    ResponseCache(const char* name, Flight& flight, bool (*cacheable)(const Value&))
+        : ResponseCacheBase(name), flight_(flight), cacheable_(cacheable) {}
+
+    /**
+     * 读取键对应的结果，按条目年龄决定直接返回、返回后后台刷新或同步加载
+     * @param fetch 参数为 Done，加载完成后调用一次
+     * @param callback 结果回调
+     */
+    template <typename Fetch>
+    void get(const Key& key, Fetch&& fetch, Callback&& callback) {
+        const auto& cfg = config();
+        if (!cfg.enabled) {
+            flight_.run(key, std::forward<Fetch>(fetch), std::move(callback));
+            return;
+        }
+
+        ValuePtr cached;
+        bool refresh = false;
+        bool fresh = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                auto age = Clock::now() - it->second.loadedAt;
+                if (age < cfg.maxStale) {
+                    cached = it->second.value;
+                    fresh = age < cfg.ttl;
+                    if (age >= cfg.refreshAhead && !it->second.refreshing) {
+                        it->second.refreshing = true;
+                        refresh = true;
+                    }
+                }
+            }
+        }
+
+        if (cached) {
+            (fresh ? stats_.freshHits : stats_.staleHits).fetch_add(1, std::memory_order_relaxed);
+            callback(cached);
+            if (refresh) {
+                stats_.refreshes.fetch_add(1, std::memory_order_relaxed);
+                flight_.run(key, storing(key, std::forward<Fetch>(fetch)), [](const ValuePtr&) {});
+            }
+            return;
+        }
+
+        stats_.misses.fetch_add(1, std::memory_order_relaxed);
+        flight_.run(key, storing(key, std::forward<Fetch>(fetch)), std::move(callback));
+    }
+
+    /**
+     * 删除一个键（数据变化且需要立即可见时调用）
+     */
+    void invalidate(const Key& key) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.erase(key);
+            if (loading_ > 0) {
+                invalidatedAt_[key] = ++sequence_;
+                if (invalidatedAt_.size() > config().maxEntries) {
+                    // 记录过多时按全部失效处理
+                    clearedAt_ = sequence_;
+                    invalidatedAt_.clear();
+                }
+            }
+        }
+        flight_.forget(key);
+    }
+
+    /**
+     * 删除全部条目
+     */
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.clear();
+            clearedAt_ = ++sequence_;
+            invalidatedAt_.clear();
+        }
+        flight_.forgetAll();
+    }
+
+private:
+    struct Entry {
+        ValuePtr value;
+        Clock::time_point loadedAt;
+        bool refreshing;
+    };
+
+    /**
+     * 包装读取：结果先写入缓存，再分发给等待者（每次读取只写一次）
+     */
+    template <typename Fetch>
+    auto storing(const Key& key, Fetch&& fetch) {
+        return [this, key, fetch = std::forward<Fetch>(fetch)](Done done) {
+            uint64_t startedAt;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                startedAt = sequence_;
+                loading_++;
+            }
+            fetch(Done([this, key, startedAt, done](ValuePtr value) {
+                store(key, startedAt, value);
+                return done(std::move(value));
+            }));
+        };
+    }
+
+    void store(const Key& key, uint64_t startedAt, const ValuePtr& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool stale = startedAt < clearedAt_;
+        if (!stale) {
+            auto invalidated = invalidatedAt_.find(key);
+            stale = invalidated != invalidatedAt_.end() && startedAt < invalidated->second;
+        }
+        // 没有进行中的读取时，失效记录不再需要
+        if (--loading_ == 0) {
+            invalidatedAt_.clear();
+        }
+
+        if (stale) {
+            // 读取开始后该键已失效：结果可能是旧的，不写入
+            return;
+        }
+
+        if (!cacheable_(*value)) {
+            // 读取失败：保留旧条目，允许下一次请求重新刷新
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                it->second.refreshing = false;
+            }
+            return;
+        }
+
+        auto now = Clock::now();
+        if (entries_.size() >= config().maxEntries && entries_.find(key) == entries_.end()) {
+            evictExpired(now);
+            if (entries_.size() >= config().maxEntries) {
+                entries_.clear();
+            }
+        }
+        entries_[key] = Entry{value, now, false};
+    }
+
+    // 持有锁
+    void evictExpired(Clock::time_point now) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (now - it->second.loadedAt >= config().maxStale) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    Flight& flight_;
+    bool (*cacheable_)(const Value&);
+    std::mutex mutex_;
+    std::unordered_map<Key, Entry, Hash> entries_;
+
+    // 失效序号：每次 invalidate/clear 自增
+    uint64_t sequence_ = 0;
+    // 最近一次 clear 的序号
+    uint64_t clearedAt_ = 0;
+    // 读取进行中时被失效的键及其失效序号
+    std::unordered_map<Key, uint64_t, Hash> invalidatedAt_;
+    // 进行中的读取数
+    size_t loading_ = 0;
+};
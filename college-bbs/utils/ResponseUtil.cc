@@ -10,6 +10,24 @@ HttpResponsePtr ResponseUtil::success(const Json::Value& data, const std::string
     return resp;
 }
 
+HttpResponsePtr ResponseUtil::successRaw(const std::string& data_json, const std::string& msg) {
+    // 字段顺序与 Json::Value 序列化结果一致
+    std::string body;
+    body.reserve(data_json.size() + msg.size() + 32);
+    body += "{\"code\":";
+    body += std::to_string(SUCCESS);
+    body += ",\"data\":";
+    body += data_json;
+    body += ",\"msg\":";
+    body += Json::valueToQuotedString(msg.c_str());
+    body += "}";
+
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    return resp;
+}
+
 HttpResponsePtr ResponseUtil::error(int code, const std::string& msg) {
     Json::Value response;
     response["code"] = code;
@@ -55,6 +73,10 @@ std::string ResponseUtil::getErrorMessage(int code) {
             return "数据库错误";
         case SERVER_ERROR:
             return "服务器内部错误";
+        case TOO_MANY_REQUESTS:
+            return "请求过于频繁";
+        case SERVER_BUSY:
+            return "服务繁忙";
         default:
             return "未知错误";
     }
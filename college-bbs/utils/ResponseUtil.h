@@ -23,7 +23,9 @@ public:
         POST_NOT_FOUND = 1007,  // 帖子不存在
         REPLY_NOT_FOUND = 1008, // 回复不存在
         DB_ERROR = 1009,        // 数据库错误
-        SERVER_ERROR = 1010     // 服务器内部错误
+        SERVER_ERROR = 1010,    // 服务器内部错误
+        TOO_MANY_REQUESTS = 1011, // 请求过于频繁
+        SERVER_BUSY = 1012      // 服务繁忙（过载保护）
     };
 
     /**
@@ -35,6 +37,15 @@ public:
     static HttpResponsePtr success(const Json::Value& data = Json::Value::null,
                                    const std::string& msg = "success");
 
+    /**
+     * 成功响应（data为已序列化的JSON，直接拼接不再解析）
+     * @param data_json 序列化后的data字段
+     * @param msg 响应消息
+     * @return HttpResponse
+     */
+    static HttpResponsePtr successRaw(const std::string& data_json,
+                                      const std::string& msg = "success");
+
     /**
      * 失败响应
      * @param code 错误码
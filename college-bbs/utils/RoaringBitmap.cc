@@ -0,0 +1,153 @@
+#include "RoaringBitmap.h"
+#include <algorithm>
+
+const uint32_t RoaringBitmap::ARRAY_MAX_SIZE;
+const size_t RoaringBitmap::BITMAP_WORDS;
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitmap()) {
+        return (bitmap[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool RoaringBitmap::Container::add(uint16_t low) {
+    if (isBitmap()) {
+        uint64_t mask = uint64_t(1) << (low & 63);
+        uint64_t& word = bitmap[low >> 6];
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        cardinality++;
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) {
+        return false;
+    }
+    array.insert(it, low);
+    cardinality++;
+
+    // 超过阈值后位图更省空间
+    if (cardinality > ARRAY_MAX_SIZE) {
+        toBitmap();
+    }
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(uint16_t low) {
+    if (isBitmap()) {
+        uint64_t mask = uint64_t(1) << (low & 63);
+        uint64_t& word = bitmap[low >> 6];
+        if (!(word & mask)) {
+            return false;
+        }
+        word &= ~mask;
+        cardinality--;
+
+        if (cardinality <= ARRAY_MAX_SIZE) {
+            toArray();
+        }
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) {
+        return false;
+    }
+    array.erase(it);
+    cardinality--;
+    return true;
+}
+
+void RoaringBitmap::Container::toBitmap() {
+    bitmap.assign(BITMAP_WORDS, 0);
+    for (uint16_t low : array) {
+        bitmap[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    std::vector<uint16_t>().swap(array);
+}
+
+void RoaringBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(cardinality);
+    for (size_t i = 0; i < BITMAP_WORDS; i++) {
+        uint64_t word = bitmap[i];
+        while (word) {
+            int bit = __builtin_ctzll(word);
+            array.push_back(static_cast<uint16_t>(i * 64 + bit));
+            word &= word - 1;
+        }
+    }
+    std::vector<uint64_t>().swap(bitmap);
+}
+
+std::vector<RoaringBitmap::Container>::const_iterator RoaringBitmap::findContainer(uint16_t key) const {
+    return std::lower_bound(containers_.begin(), containers_.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+std::vector<RoaringBitmap::Container>::iterator RoaringBitmap::findContainer(uint16_t key) {
+    return std::lower_bound(containers_.begin(), containers_.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = findContainer(key);
+    if (it == containers_.end() || it->key != key) {
+        return false;
+    }
+    return it->contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+bool RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = findContainer(key);
+    if (it == containers_.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        it = containers_.insert(it, std::move(c));
+    }
+    return it->add(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+bool RoaringBitmap::remove(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = findContainer(key);
+    if (it == containers_.end() || it->key != key) {
+        return false;
+    }
+
+    bool removed = it->remove(static_cast<uint16_t>(value & 0xFFFF));
+
+    // 空容器直接移除
+    if (removed && it->cardinality == 0) {
+        containers_.erase(it);
+    }
+    return removed;
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& c : containers_) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+size_t RoaringBitmap::memoryUsage() const {
+    size_t bytes = sizeof(*this) + containers_.capacity() * sizeof(Container);
+    for (const auto& c : containers_) {
+        bytes += c.array.capacity() * sizeof(uint16_t);
+        bytes += c.bitmap.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+size_t RoaringBitmap::bitmapContainers() const {
+    return std::count_if(containers_.begin(), containers_.end(),
+                         [](const Container& c) { return c.isBitmap(); });
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * 压缩位图（Roaring风格）
+ *
+ * 按高16位把整数划分到不同的容器中，每个容器保存低16位：
+ * - 元素较少时使用有序数组（每个元素2字节）
+ * - 元素超过4096个时转换为定长位图（8KB）
+ *
+ * 用于按 post_id 存储用户点赞集合，稀疏时内存占用很小，
+ * 查询只需一次二分查找加一次数组/位运算
+ */
+class RoaringBitmap {
+public:
+    /**
+     * 判断是否包含某个值
+     */
+    bool contains(uint32_t value) const;
+
+    /**
+     * 添加一个值
+     * @return true=新插入，false=已存在
+     */
+    bool add(uint32_t value);
+
+    /**
+     * 删除一个值
+     * @return true=删除成功，false=原本不存在
+     */
+    bool remove(uint32_t value);
+
+    /**
+     * 元素个数
+     */
+    size_t cardinality() const;
+
+    /**
+     * 估算内存占用（字节）
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * 使用定长位图的容器个数（其余为数组容器）
+     */
+    size_t bitmapContainers() const;
+
+private:
+    // 数组容器与位图容器的切换阈值
+    static const uint32_t ARRAY_MAX_SIZE = 4096;
+    // 位图容器的64位字数量（65536 / 64）
+    static const size_t BITMAP_WORDS = 1024;
+
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;   // 稀疏时使用，有序
+        std::vector<uint64_t> bitmap;  // 稠密时使用，大小为BITMAP_WORDS
+
+        bool isBitmap() const { return !bitmap.empty(); }
+        bool contains(uint16_t low) const;
+        bool add(uint16_t low);
+        bool remove(uint16_t low);
+        void toBitmap();
+        void toArray();
+    };
+
+    // 按key有序排列
+    std::vector<Container> containers_;
+
+    /**
+     * 查找key对应容器的位置（lower_bound）
+     */
+    std::vector<Container>::const_iterator findContainer(uint16_t key) const;
+    std::vector<Container>::iterator findContainer(uint16_t key);
+};
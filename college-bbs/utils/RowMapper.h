@@ -0,0 +1,76 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <drogon/orm/Result.h>
+#include <atomic>
+#include <cstring>
+
+/**
+ * 按列位置解码查询结果
+ *
+ * 按列名读取（row["title"]）时每行的每一列都要按名字查找一次列号，
+ * 回复多的帖子详情一次要解码几千行。行类型（models/ 下）在编译期声明列表 COLUMNS，
+ * 顺序与对应SQL的选择列表一致，decode() 直接按位置读取：
+ *   sql::forEachRow<models::ReplyRow>(r, [&](models::ReplyRow&& reply) { ... });
+ *
+ * 每个行类型第一次解码非空结果时核对一次列名与 COLUMNS 是否一致，
+ * 不一致（改了SQL的选择列表但没有同步修改行类型）时输出错误日志
+ */
+namespace sql {
+
+/**
+ * 按位置读取一列（行类型的 decode() 中使用）
+ */
+template <typename T>
+T field(const drogon::orm::Row& row, drogon::orm::Row::SizeType index) {
+    return row[index].template as<T>();
+}
+
+/**
+ * 结果的列名是否与行类型声明的列表一致
+ */
+template <typename Row>
+bool columnsMatch(const drogon::orm::Result& r) {
+    if (r.columns() != Row::COLUMNS.size()) {
+        return false;
+    }
+    for (drogon::orm::Result::RowSizeType i = 0; i < r.columns(); i++) {
+        if (std::strcmp(r.columnName(i), Row::COLUMNS[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Row>
+void checkColumns(const drogon::orm::Result& r) {
+    static std::atomic<bool> checked{false};
+    if (r.empty() || checked.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    if (!columnsMatch<Row>(r)) {
+        LOG_ERROR << "Column list of " << Row::NAME << " does not match the query result";
+    }
+}
+
+/**
+ * 逐行解码：fn(Row&&)
+ */
+template <typename Row, typename Fn>
+void forEachRow(const drogon::orm::Result& r, Fn&& fn) {
+    checkColumns<Row>(r);
+    for (const auto& row : r) {
+        fn(Row::decode(row));
+    }
+}
+
+/**
+ * 解码第一行（调用方先确认结果非空）
+ */
+template <typename Row>
+Row firstRow(const drogon::orm::Result& r) {
+    checkColumns<Row>(r);
+    return Row::decode(r[0]);
+}
+
+} // namespace sql
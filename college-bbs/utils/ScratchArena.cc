@@ -0,0 +1,41 @@
+#include "ScratchArena.h"
+
+ScratchArena::ScratchArena()
+    : resource_(initial_, sizeof(initial_), &upstream_) {}
+
+uint32_t ScratchArena::allocations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocations_;
+}
+
+uint32_t ScratchArena::heapAllocations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return upstream_.count;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_++;
+    return resource_.allocate(bytes, alignment);
+}
+
+void ScratchArena::do_deallocate(void*, size_t, size_t) {
+    // 单调分配：内存随上下文一起释放
+}
+
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void* ScratchArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    count++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void ScratchArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool ScratchArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+
+/**
+ * 请求级临时内存池
+ *
+ * 随请求上下文创建，请求结束、上下文释放时整体释放。
+ * 处理请求过程中的临时容器（解析出的ID列表、追踪片段等）用PMR容器从这里分配，
+ * 前 INITIAL_SIZE 字节来自上下文内部的缓冲区，不用时不产生任何堆分配；
+ * 单个释放为空操作
+ *
+ * 数据库回调可能在不同线程上执行，分配时加锁（同一请求的回调基本是串行的，锁无竞争）
+ */
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    static const size_t INITIAL_SIZE = 1024;
+
+    ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * 从内存池分配的次数
+     */
+    uint32_t allocations() const;
+
+    /**
+     * 内存池向堆申请新内存块的次数（初始缓冲区用完后才会发生）
+     */
+    uint32_t heapAllocations() const;
+
+private:
+    /**
+     * 统计向堆申请的次数
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        uint32_t count = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    mutable std::mutex mutex_;
+    alignas(std::max_align_t) char initial_[INITIAL_SIZE];
+    CountingResource upstream_;
+    std::pmr::monotonic_buffer_resource resource_;
+    uint32_t allocations_ = 0;
+};
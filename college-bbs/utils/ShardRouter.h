@@ -0,0 +1,132 @@
+#pragma once
+
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * 按帖子ID把进程内状态分片到IO线程（shared-nothing）
+ *
+ * 同一帖子的请求会落到任意IO线程上，按帖子保存的内存状态（浏览次数、计数器等）
+ * 只能加锁或用原子操作，线程越多争用越重。这里每个IO线程独占一个分片：
+ * 帖子ID哈希到所属线程，修改一律通过 runInLoop（不在所属线程时即 queueInLoop）
+ * 投递到所属线程执行，分片内的数据不需要任何锁
+ *
+ * 其他线程读取时使用只读快照：分片被修改后，所属线程在本轮事件循环末尾
+ * 生成一次快照并原子替换，读取方拿到的快照不会再变化（最多落后一轮事件循环）
+ *
+ * 用法：
+ *   static ShardRouter<std::unordered_map<int, int>, uint64_t> views(sumViews);
+ *   views.update(post_id, [post_id](auto& pending) { pending[post_id]++; });
+ *   uint64_t total = *views.snapshot(0);
+ *
+ * 必须在框架启动（IO线程创建）之后使用
+ */
+template <typename State, typename Snapshot = State>
+class ShardRouter {
+public:
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+    using MakeSnapshot = Snapshot (*)(const State&);
+
+    /**
+     * @param makeSnapshot 由分片状态生成快照，在所属线程上调用（默认复制整个状态）
+     */
+    explicit ShardRouter(MakeSnapshot makeSnapshot = &copyState) : makeSnapshot_(makeSnapshot) {}
+
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    /**
+     * 分片数（等于IO线程数）
+     */
+    size_t shardCount() { return shards().size(); }
+
+    /**
+     * 帖子ID所属的分片
+     */
+    size_t shardOf(int key) { return static_cast<unsigned int>(key) % shardCount(); }
+
+    /**
+     * 在帖子ID所属的线程上修改分片：fn(State&)
+     * 当前就在所属线程时直接执行，否则排队执行；fn 中的回调也在所属线程上调用
+     */
+    template <typename Fn>
+    void update(int key, Fn&& fn) {
+        updateShard(shardOf(key), std::forward<Fn>(fn));
+    }
+
+    /**
+     * 在指定分片的线程上修改分片
+     */
+    template <typename Fn>
+    void updateShard(size_t index, Fn&& fn) {
+        Shard* shard = shards()[index].get();
+        shard->loop->runInLoop([this, shard, fn = std::forward<Fn>(fn)]() mutable {
+            fn(shard->state);
+            schedulePublish(shard);
+        });
+    }
+
+    /**
+     * 在每个分片的线程上各执行一次 fn(State&)
+     */
+    template <typename Fn>
+    void forEach(const Fn& fn) {
+        for (size_t i = 0; i < shardCount(); i++) {
+            updateShard(i, fn);
+        }
+    }
+
+    /**
+     * 分片的最新快照，可在任意线程调用
+     */
+    SnapshotPtr snapshot(size_t index) {
+        return std::atomic_load(&shards()[index]->snapshot);
+    }
+
+private:
+    struct Shard {
+        trantor::EventLoop* loop;
+        State state;
+        SnapshotPtr snapshot;
+        bool publishQueued = false;  // 只在所属线程上访问
+    };
+
+    static Snapshot copyState(const State& state) { return state; }
+
+    std::vector<std::unique_ptr<Shard>>& shards() {
+        std::call_once(initOnce_, [this]() {
+            size_t count = std::max<size_t>(1, drogon::app().getThreadNum());
+            for (size_t i = 0; i < count; i++) {
+                auto shard = std::make_unique<Shard>();
+                shard->loop = drogon::app().getIOLoop(i);
+                shard->snapshot = std::make_shared<const Snapshot>(makeSnapshot_(shard->state));
+                shards_.push_back(std::move(shard));
+            }
+        });
+        return shards_;
+    }
+
+    /**
+     * 本轮事件循环的修改全部执行完后生成一次快照
+     */
+    void schedulePublish(Shard* shard) {
+        if (shard->publishQueued) {
+            return;
+        }
+        shard->publishQueued = true;
+        shard->loop->queueInLoop([this, shard]() {
+            shard->publishQueued = false;
+            std::atomic_store(&shard->snapshot, std::make_shared<const Snapshot>(makeSnapshot_(shard->state)));
+        });
+    }
+
+    MakeSnapshot makeSnapshot_;
+    std::once_flag initOnce_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
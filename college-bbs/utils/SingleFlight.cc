@@ -0,0 +1,26 @@
+#include "SingleFlight.h"
+#include <drogon/drogon.h>
+
+namespace {
+
+std::vector<const SingleFlightGroup*>& registry() {
+    static std::vector<const SingleFlightGroup*> groups;
+    return groups;
+}
+
+} // namespace
+
+SingleFlightGroup::SingleFlightGroup(const char* name)
+    : name_(name) {
+    registry().push_back(this);
+}
+
+bool SingleFlightGroup::enabled() {
+    static const bool enabled =
+        drogon::app().getCustomConfig()["single_flight"].get("enabled", true).asBool();
+    return enabled;
+}
+
+const std::vector<const SingleFlightGroup*>& SingleFlightGroup::all() {
+    return registry();
+}
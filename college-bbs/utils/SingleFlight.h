@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 并发相同读请求合并（single-flight）
+ *
+ * 帖子被转发到群聊后，同一秒内有成百上千个请求读取同一个帖子，
+ * 每个请求都单独执行一遍相同的查询。按查询标识（如帖子ID、分页参数）分组：
+ * 同一个键同一时间只有一次数据库读取在进行，期间到达的相同请求不再查询，
+ * 挂到这次读取上，结果出来后分发给所有等待者
+ *
+ * 只合并进行中的读取，不缓存结果：读取完成后下一个请求会重新查询
+ * 各IO线程共用同一个分组（加锁保护，临界区只有一次哈希表查找）
+ *
+ * 配置（custom_config.single_flight）：
+ * - enabled: 是否启用，关闭时每个请求都单独读取
+ */
+class SingleFlightGroup {
+public:
+    explicit SingleFlightGroup(const char* name);
+    virtual ~SingleFlightGroup() = default;
+
+    SingleFlightGroup(const SingleFlightGroup&) = delete;
+    SingleFlightGroup& operator=(const SingleFlightGroup&) = delete;
+
+    const char* name() const { return name_; }
+
+    /**
+     * 实际发起的读取次数
+     */
+    uint64_t flights() const { return flights_.load(std::memory_order_relaxed); }
+
+    /**
+     * 挂到进行中读取上、没有单独查询的请求数
+     */
+    uint64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+    /**
+     * 是否启用合并
+     */
+    static bool enabled();
+
+    /**
+     * 全部分组（用于导出指标）
+     */
+    static const std::vector<const SingleFlightGroup*>& all();
+
+protected:
+    std::atomic<uint64_t> flights_{0};
+    std::atomic<uint64_t> coalesced_{0};
+
+private:
+    const char* name_;
+};
+
+/**
+ * 按键合并读取的分组
+ *
+ * 用法：
+ *   static SingleFlight<int, Result> detailFlight("post_detail");
+ *   detailFlight.run(post_id,
+ *       [](SingleFlight<int, Result>::Done done) {
+ *           // 发起查询，完成后调用一次 done(结果)
+ *       },
+ *       [callback](const std::shared_ptr<const Result>& result) {
+ *           // 每个等待者各自构造响应
+ *       });
+ *
+ * 结果为共享的只读对象，等待者不能修改
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight : public SingleFlightGroup {
+public:
+    using ValuePtr = std::shared_ptr<const Value>;
+    using Callback = std::function<void(const ValuePtr&)>;
+
+    // 读取完成，分发结果；返回合并到这次读取上的请求数（不含发起者）。必须且只能调用一次
+    using Done = std::function<size_t(ValuePtr)>;
+
+    using SingleFlightGroup::SingleFlightGroup;
+
+    /**
+     * 读取键对应的结果：没有进行中的读取时调用 fetch 发起，否则等待进行中的读取
+     * @param fetch 参数为 Done，在当前线程同步调用
+     * @param callback 结果回调，在完成读取的线程上调用
+     */
+    template <typename Fetch>
+    void run(const Key& key, Fetch&& fetch, Callback&& callback) {
+        if (!enabled()) {
+            flights_.fetch_add(1, std::memory_order_relaxed);
+            auto cb = std::make_shared<Callback>(std::move(callback));
+            fetch(Done([cb](ValuePtr value) -> size_t {
+                (*cb)(value);
+                return 0;
+            }));
+            return;
+        }
+
+        std::shared_ptr<Waiters> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = waiters_.find(key);
+            if (it != waiters_.end()) {
+                it->second->push_back(std::move(callback));
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            waiters = std::make_shared<Waiters>();
+            waiters->push_back(std::move(callback));
+            waiters_.emplace(key, waiters);
+        }
+
+        flights_.fetch_add(1, std::memory_order_relaxed);
+        fetch(Done([this, key, waiters](ValuePtr value) {
+            return finish(key, waiters, value);
+        }));
+    }
+
+    /**
+     * 之后的请求不再挂到进行中的读取上（数据已变化，进行中读取的结果可能是旧的）
+     * 进行中的读取照常完成，结果只分发给已挂上的等待者
+     */
+    void forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiters_.erase(key);
+    }
+
+    /**
+     * 对全部键调用 forget
+     */
+    void forgetAll() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiters_.clear();
+    }
+
+private:
+    using Waiters = std::vector<Callback>;
+
+    size_t finish(const Key& key, const std::shared_ptr<Waiters>& waiters, const ValuePtr& value) {
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 未被 forget 时从分组中移除
+            auto it = waiters_.find(key);
+            if (it != waiters_.end() && it->second == waiters) {
+                waiters_.erase(it);
+            }
+            callbacks = std::move(*waiters);
+            waiters->clear();
+        }
+
+        // 锁外分发，等待者回调中可以再次发起同一个键的读取
+        for (auto& callback : callbacks) {
+            callback(value);
+        }
+        return callbacks.empty() ? 0 : callbacks.size() - 1;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<Key, std::shared_ptr<Waiters>, Hash> waiters_;
+};
@@ -0,0 +1,371 @@
+#include "SqlStatements.h"
+#include <drogon/drogon.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+using namespace drogon::orm;
+
+namespace sql {
+
+namespace {
+
+std::vector<const StatementBase*>& registry() {
+    static std::vector<const StatementBase*> statements;
+    return statements;
+}
+
+bool advisorEnabled() {
+    static const bool enabled = drogon::app().getCustomConfig()["sql_advisor"].get("enabled", true).asBool();
+    return enabled;
+}
+
+/**
+ * 按列名读取 EXPLAIN 结果中的一列（列不存在或为NULL时返回空串）
+ */
+std::string column(const Result& r, Result::SizeType row, const char* name) {
+    for (Result::RowSizeType i = 0; i < r.columns(); i++) {
+        if (std::strcmp(r.columnName(i), name) == 0) {
+            return r[row][i].isNull() ? std::string() : r[row][i].as<std::string>();
+        }
+    }
+    return std::string();
+}
+
+/**
+ * 检查执行计划，返回警告条数
+ */
+size_t advise(const StatementBase* stmt, const Result& r) {
+    size_t warnings = 0;
+    for (Result::SizeType i = 0; i < r.size(); i++) {
+        std::string table = column(r, i, "table");
+        std::string type = column(r, i, "type");
+        std::string extra = column(r, i, "Extra");
+
+        std::string problem;
+        if (type == "ALL") {
+            problem = "full table scan";
+        } else if (type == "index") {
+            problem = "full index scan";
+        } else if (extra.find("Using filesort") != std::string::npos) {
+            problem = "filesort";
+        } else if (extra.find("Using temporary") != std::string::npos) {
+            problem = "temporary table";
+        } else {
+            continue;
+        }
+        LOG_WARN << "SQL plan for " << stmt->name() << ": " << problem << " on " << table
+                 << " (key=" << column(r, i, "key") << ", rows=" << column(r, i, "rows")
+                 << ", extra=" << extra << ")";
+        warnings++;
+    }
+    return warnings;
+}
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+} // namespace
+
+StatementBase::StatementBase(const char* name, const char* text)
+    : name_(name), text_(text) {
+    registry().push_back(this);
+}
+
+uint64_t StatementBase::recordSuccess(std::chrono::steady_clock::time_point start) const {
+    auto micros = elapsedMicros(start);
+    stats_.executions.fetch_add(1, std::memory_order_relaxed);
+    stats_.latency.record(micros);
+    return micros;
+}
+
+uint64_t StatementBase::recordError(std::chrono::steady_clock::time_point start) const {
+    auto micros = elapsedMicros(start);
+    stats_.executions.fetch_add(1, std::memory_order_relaxed);
+    stats_.errors.fetch_add(1, std::memory_order_relaxed);
+    stats_.latency.record(micros);
+    return micros;
+}
+
+const std::vector<const StatementBase*>& all() {
+    return registry();
+}
+
+void warmUp(const DbClientPtr& client) {
+    // 回调在各连接的线程上执行
+    struct Progress {
+        std::atomic<size_t> remaining;
+        std::atomic<size_t> failed{0};
+        std::atomic<size_t> planWarnings{0};
+    };
+    auto progress = std::make_shared<Progress>();
+    progress->remaining = all().size();
+
+    auto finish = [progress]() {
+        if (--progress->remaining == 0) {
+            LOG_INFO << "SQL warm-up finished: " << all().size() << " statements, "
+                     << progress->failed << " failed, " << progress->planWarnings << " plan warnings";
+        }
+    };
+
+    // 语句并发发出，会分散到连接池中的各个连接上
+    for (const auto* stmt : all()) {
+        stmt->explainAsync(
+            client,
+            [progress, finish, stmt](const Result& r) {
+                if (advisorEnabled()) {
+                    progress->planWarnings += advise(stmt, r);
+                }
+                finish();
+            },
+            [progress, finish, stmt](const DrogonDbException& e) {
+                LOG_ERROR << "SQL warm-up failed for " << stmt->name() << ": " << e.base().what();
+                progress->failed++;
+                finish();
+            }
+        );
+    }
+}
+
+void execInAsync(const RequestContextPtr& ctx,
+                 const DbClientPtr& client,
+                 const Statement<int>& statement,
+                 const int* ids, size_t count,
+                 ResultCallback&& callback,
+                 ExceptionCallback&& errorCallback) {
+    std::string text = statement.text();
+    std::string placeholders;
+    placeholders.reserve(3 * count);
+    for (size_t i = 1; i < count; i++) {
+        placeholders += ", ?";
+    }
+    text.insert(text.rfind(')'), placeholders);
+
+    auto start = std::chrono::steady_clock::now();
+    const StatementBase* stmt = &statement;
+    AdmissionController::queryStarted();
+
+    auto binder = *client << text;
+    for (size_t i = 0; i < count; i++) {
+        binder << ids[i];
+    }
+    binder >> [ctx, stmt, start, callback = std::move(callback)](const Result& r) {
+        auto micros = stmt->recordSuccess(start);
+        AdmissionController::queryFinished(micros);
+        if (ctx) {
+            ctx->recordQuery(stmt->name(), start, micros, true);
+        }
+        callback(r);
+    };
+    binder >> [ctx, stmt, start, errorCallback = std::move(errorCallback)](const DrogonDbException& e) {
+        auto micros = stmt->recordError(start);
+        AdmissionController::queryFinished(micros);
+        if (ctx) {
+            ctx->recordQuery(stmt->name(), start, micros, false);
+        }
+        errorCallback(e);
+    };
+    binder.exec();
+}
+
+// ============================================
+// 用户 (users)
+// ============================================
+const Statement<int, int> USER_NAMES_AFTER(
+    "user.names_after",
+    "SELECT id, username FROM users WHERE id > ? ORDER BY id LIMIT ?");
+
+// 执行时按ID数量在 "IN (?)" 中追加 ", ?"
+const Statement<int> USER_NAMES_BY_IDS(
+    "user.names_by_ids",
+    "SELECT id, username FROM users WHERE id IN (?)");
+
+const Statement<std::string, std::string, std::string> USER_INSERT(
+    "user.insert",
+    "INSERT INTO users (username, password_hash, email) VALUES (?, ?, ?)");
+
+const Statement<std::string> USER_LOGIN(
+    "user.login",
+    "SELECT id, username, password_hash FROM users WHERE username = ? LIMIT 1");
+
+const Statement<int> USER_INFO(
+    "user.info",
+    R"(
+        SELECT
+            u.id,
+            u.username,
+            u.email,
+            u.avatar_url,
+            u.created_at,
+            (SELECT COUNT(*) FROM posts WHERE user_id = u.id AND deleted_at IS NULL) as post_count,
+            (SELECT COUNT(*) FROM replies r JOIN posts p ON p.id = r.post_id
+             WHERE r.user_id = u.id AND p.deleted_at IS NULL) as reply_count
+        FROM users u
+        WHERE u.id = ?
+        LIMIT 1
+    )");
+
+// ============================================
+// 帖子 (posts)
+// 删除为软删除（deleted_at），所有读取都要过滤已删除的帖子
+// ============================================
+const Statement<int, std::string, std::string> POST_INSERT(
+    "post.insert",
+    "INSERT INTO posts (user_id, title, content) VALUES (?, ?, ?)");
+
+const Statement<> POST_COUNT(
+    "post.count",
+    "SELECT COUNT(*) as total FROM posts WHERE deleted_at IS NULL");
+
+// 只取ID，摘要优先从预渲染缓存中获取
+const Statement<int, int> POST_LIST_IDS(
+    "post.list_ids",
+    "SELECT id FROM posts WHERE deleted_at IS NULL ORDER BY created_at DESC LIMIT ? OFFSET ?");
+
+// 执行时按ID数量在 "IN (?)" 中追加 ", ?"
+const Statement<int> POST_SUMMARIES_BY_IDS(
+    "post.summaries_by_ids",
+    R"(
+        SELECT
+            id,
+            title,
+            view_count,
+            like_count,
+            reply_count,
+            created_at,
+            user_id as author_id
+        FROM posts
+        WHERE id IN (?) AND deleted_at IS NULL
+    )");
+
+const Statement<int> POST_DETAIL(
+    "post.detail",
+    R"(
+        SELECT
+            p.id,
+            p.title,
+            p.content,
+            p.view_count,
+            p.like_count,
+            p.reply_count,
+            p.created_at,
+            p.user_id as author_id
+        FROM posts p
+        WHERE p.id = ? AND p.deleted_at IS NULL
+        LIMIT 1
+    )");
+
+const Statement<int> POST_EXISTS(
+    "post.exists",
+    "SELECT id FROM posts WHERE id = ? AND deleted_at IS NULL LIMIT 1");
+
+const Statement<int> POST_OWNER(
+    "post.owner",
+    "SELECT user_id FROM posts WHERE id = ? AND deleted_at IS NULL LIMIT 1");
+
+// 只标记删除，回复和点赞由 PostPurger 在后台分批清除
+// 带上 user_id 条件，一条语句完成权限检查和删除；影响0行时再用 POST_OWNER 区分不存在和无权限
+const Statement<int, int> POST_DELETE(
+    "post.delete",
+    "UPDATE posts SET deleted_at = CURRENT_TIMESTAMP WHERE id = ? AND user_id = ? AND deleted_at IS NULL");
+
+// 最早删除、尚未清除的帖子
+const Statement<> POST_PURGE_NEXT(
+    "post.purge_next",
+    "SELECT id FROM posts WHERE deleted_at IS NOT NULL ORDER BY deleted_at LIMIT 1");
+
+// 回复和点赞清除完后删除帖子本身（此时级联删除已无行可删）
+const Statement<int> POST_PURGE(
+    "post.purge",
+    "DELETE FROM posts WHERE id = ? AND deleted_at IS NOT NULL");
+
+const Statement<int, int> POST_ADD_VIEWS(
+    "post.add_views",
+    "UPDATE posts SET view_count = view_count + ? WHERE id = ?");
+
+const Statement<int> POST_LIKE_COUNT(
+    "post.like_count",
+    "SELECT like_count FROM posts WHERE id = ?");
+
+const Statement<int> POST_INCREMENT_LIKE(
+    "post.increment_like",
+    "UPDATE posts SET like_count = like_count + 1 WHERE id = ?");
+
+const Statement<int> POST_DECREMENT_LIKE(
+    "post.decrement_like",
+    "UPDATE posts SET like_count = like_count - 1 WHERE id = ? AND like_count > 0");
+
+const Statement<int> POST_INCREMENT_REPLY(
+    "post.increment_reply",
+    "UPDATE posts SET reply_count = reply_count + 1 WHERE id = ?");
+
+const Statement<int, int> POST_ADD_REPLIES(
+    "post.add_replies",
+    "UPDATE posts SET reply_count = reply_count + ? WHERE id = ?");
+
+const Statement<int> POST_DECREMENT_REPLY(
+    "post.decrement_reply",
+    "UPDATE posts SET reply_count = reply_count - 1 WHERE id = ?");
+
+// ============================================
+// 回复 (replies)
+// ============================================
+const Statement<int, int, std::string> REPLY_INSERT(
+    "reply.insert",
+    "INSERT INTO replies (post_id, user_id, content) VALUES (?, ?, ?)");
+
+// 多行插入：执行时按批量大小追加 ", (?, ?, ?)"
+const Statement<int, int, std::string> REPLY_INSERT_BATCH(
+    "reply.insert_batch",
+    "INSERT INTO replies (post_id, user_id, content) VALUES (?, ?, ?)");
+
+const Statement<int> REPLY_LIST_BY_POST(
+    "reply.list_by_post",
+    R"(
+        SELECT
+            r.id,
+            r.content,
+            r.created_at,
+            r.user_id as author_id
+        FROM replies r
+        WHERE r.post_id = ?
+        ORDER BY r.created_at ASC
+    )");
+
+const Statement<int> REPLY_OWNER(
+    "reply.owner",
+    "SELECT user_id, post_id FROM replies WHERE id = ? LIMIT 1");
+
+// 带所有者条件的删除（参数: reply_id, user_id），影响行数为 0 表示未删除
+const Statement<int, int> REPLY_DELETE(
+    "reply.delete",
+    "DELETE FROM replies WHERE id = ? AND user_id = ?");
+
+const Statement<int, int> REPLY_PURGE_BATCH(
+    "reply.purge_batch",
+    "DELETE FROM replies WHERE post_id = ? LIMIT ?");
+
+// ============================================
+// 点赞 (post_likes)
+// ============================================
+// 使用INSERT IGNORE避免并发时UNIQUE约束冲突
+const Statement<int, int> LIKE_INSERT(
+    "like.insert",
+    "INSERT IGNORE INTO post_likes (post_id, user_id) VALUES (?, ?)");
+
+const Statement<int, int> LIKE_DELETE(
+    "like.delete",
+    "DELETE FROM post_likes WHERE post_id = ? AND user_id = ?");
+
+const Statement<int> LIKE_POSTS_BY_USER(
+    "like.posts_by_user",
+    "SELECT post_id FROM post_likes WHERE user_id = ?");
+
+const Statement<int, int> LIKE_PURGE_BATCH(
+    "like.purge_batch",
+    "DELETE FROM post_likes WHERE post_id = ? LIMIT ?");
+
+} // namespace sql
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "AdmissionController.h"
+#include "LatencyHistogram.h"
+#include "RequestContext.h"
+#include <drogon/orm/DbClient.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * SQL语句注册表
+ *
+ * 所有控制器使用的SQL语句都在这里集中定义：
+ * 1. 每条语句有唯一名称，并在类型上声明参数列表，参数个数/类型写错时编译失败
+ * 2. 通过 sql::execAsync() 执行，自动记录执行次数、错误次数和延迟直方图
+ * 3. 服务启动时 sql::warmUp() 对每条语句执行一次 EXPLAIN，
+ *    提前发现表结构不匹配的语句，同时预热连接池中的连接；
+ *    执行计划中有全表扫描、全索引扫描、文件排序或临时表时输出警告（通常是缺少索引）
+ *
+ * 新增SQL时在 SqlStatements.cc 中定义，并在本文件中声明
+ */
+namespace sql {
+
+/**
+ * 单条语句的运行统计
+ */
+struct StatementStats {
+    std::atomic<uint64_t> executions{0};
+    std::atomic<uint64_t> errors{0};
+    LatencyHistogram latency;
+};
+
+/**
+ * 语句基类（不含参数类型信息）
+ */
+class StatementBase {
+public:
+    StatementBase(const char* name, const char* text);
+    virtual ~StatementBase() = default;
+
+    StatementBase(const StatementBase&) = delete;
+    StatementBase& operator=(const StatementBase&) = delete;
+
+    const char* name() const { return name_; }
+    const char* text() const { return text_; }
+    StatementStats& stats() const { return stats_; }
+
+    /**
+     * 记录一次成功执行
+     * @return 本次执行耗时（微秒）
+     */
+    uint64_t recordSuccess(std::chrono::steady_clock::time_point start) const;
+
+    /**
+     * 记录一次失败执行
+     * @return 本次执行耗时（微秒）
+     */
+    uint64_t recordError(std::chrono::steady_clock::time_point start) const;
+
+    /**
+     * 以默认参数值执行 EXPLAIN（用于启动检查和预热）
+     */
+    virtual void explainAsync(const drogon::orm::DbClientPtr& client,
+                              drogon::orm::ResultCallback&& callback,
+                              drogon::orm::ExceptionCallback&& errorCallback) const = 0;
+
+private:
+    const char* name_;
+    const char* text_;
+    mutable StatementStats stats_;
+};
+
+/**
+ * 带参数类型的语句定义
+ */
+template <typename... Params>
+class Statement : public StatementBase {
+public:
+    using StatementBase::StatementBase;
+
+    void explainAsync(const drogon::orm::DbClientPtr& client,
+                      drogon::orm::ResultCallback&& callback,
+                      drogon::orm::ExceptionCallback&& errorCallback) const override {
+        client->execSqlAsync(std::string("EXPLAIN ") + text(),
+                             std::move(callback),
+                             std::move(errorCallback),
+                             Params{}...);
+    }
+};
+
+// 阻止参数类型推导，参数按语句声明的类型转换
+template <typename T>
+struct Identity {
+    using type = T;
+};
+
+/**
+ * 执行已注册的语句
+ *
+ * 用法与 DbClient::execSqlAsync 相同，只是把SQL字符串换成语句定义，
+ * 并在最前面传入请求上下文（用于统计数据库耗时和记录追踪片段，可为空）：
+ *   sql::execAsync(ctx, dbClient, sql::POST_EXISTS, onResult, onError, post_id);
+ *
+ * @param client 数据库客户端或事务
+ */
+template <typename ClientPtr, typename ResultCb, typename ErrorCb, typename... Params>
+void execAsync(const RequestContextPtr& ctx,
+               const ClientPtr& client,
+               const Statement<Params...>& statement,
+               ResultCb&& callback,
+               ErrorCb&& errorCallback,
+               const typename Identity<Params>::type&... args) {
+    auto start = std::chrono::steady_clock::now();
+    const StatementBase* stmt = &statement;
+    AdmissionController::queryStarted();
+
+    client->execSqlAsync(
+        statement.text(),
+        [ctx, stmt, start, callback = std::forward<ResultCb>(callback)](const drogon::orm::Result& r) {
+            auto micros = stmt->recordSuccess(start);
+            AdmissionController::queryFinished(micros);
+            if (ctx) {
+                ctx->recordQuery(stmt->name(), start, micros, true);
+            }
+            callback(r);
+        },
+        [ctx, stmt, start, errorCallback = std::forward<ErrorCb>(errorCallback)](
+            const drogon::orm::DrogonDbException& e) {
+            auto micros = stmt->recordError(start);
+            AdmissionController::queryFinished(micros);
+            if (ctx) {
+                ctx->recordQuery(stmt->name(), start, micros, false);
+            }
+            errorCallback(e);
+        },
+        args...);
+}
+
+/**
+ * 执行带 "IN (?)" 的语句：按ID数量在括号内追加占位符，统计方式与 execAsync 相同
+ * @param ids/count ID数组，count大于0，由调用方控制（建议不超过500）
+ */
+void execInAsync(const RequestContextPtr& ctx,
+                 const drogon::orm::DbClientPtr& client,
+                 const Statement<int>& statement,
+                 const int* ids, size_t count,
+                 drogon::orm::ResultCallback&& callback,
+                 drogon::orm::ExceptionCallback&& errorCallback);
+
+/**
+ * 所有已注册的语句
+ */
+const std::vector<const StatementBase*>& all();
+
+/**
+ * 启动预热：对每条语句执行 EXPLAIN，记录失败的语句和有问题的执行计划
+ * 配置 custom_config.sql_advisor.enabled 为 false 时不检查执行计划
+ * （表中数据很少时优化器可能直接选择全表扫描，开发环境可以关闭）
+ */
+void warmUp(const drogon::orm::DbClientPtr& client);
+
+// ============================================
+// 用户 (users)
+// ============================================
+extern const Statement<int, int> USER_NAMES_AFTER;
+extern const Statement<int> USER_NAMES_BY_IDS;
+extern const Statement<std::string, std::string, std::string> USER_INSERT;
+extern const Statement<std::string> USER_LOGIN;
+extern const Statement<int> USER_INFO;
+
+// ============================================
+// 帖子 (posts)
+// ============================================
+extern const Statement<int, std::string, std::string> POST_INSERT;
+extern const Statement<> POST_COUNT;
+extern const Statement<int, int> POST_LIST_IDS;
+extern const Statement<int> POST_SUMMARIES_BY_IDS;
+extern const Statement<int> POST_DETAIL;
+extern const Statement<int> POST_EXISTS;
+extern const Statement<int> POST_OWNER;
+extern const Statement<int, int> POST_DELETE;
+extern const Statement<> POST_PURGE_NEXT;
+extern const Statement<int> POST_PURGE;
+extern const Statement<int, int> POST_ADD_VIEWS;
+extern const Statement<int> POST_LIKE_COUNT;
+extern const Statement<int> POST_INCREMENT_LIKE;
+extern const Statement<int> POST_DECREMENT_LIKE;
+extern const Statement<int> POST_INCREMENT_REPLY;
+extern const Statement<int, int> POST_ADD_REPLIES;
+extern const Statement<int> POST_DECREMENT_REPLY;
+
+// ============================================
+// 回复 (replies)
+// ============================================
+extern const Statement<int, int, std::string> REPLY_INSERT;
+extern const Statement<int, int, std::string> REPLY_INSERT_BATCH;
+extern const Statement<int> REPLY_LIST_BY_POST;
+extern const Statement<int> REPLY_OWNER;
+extern const Statement<int, int> REPLY_DELETE;
+extern const Statement<int, int> REPLY_PURGE_BATCH;
+
+// ============================================
+// 点赞 (post_likes)
+// ============================================
+extern const Statement<int, int> LIKE_INSERT;
+extern const Statement<int, int> LIKE_DELETE;
+extern const Statement<int> LIKE_POSTS_BY_USER;
+extern const Statement<int, int> LIKE_PURGE_BATCH;
+
+} // namespace sql
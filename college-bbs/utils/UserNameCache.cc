@@ -0,0 +1,313 @@
+#include "UserNameCache.h"
+#include "RedisCache.h"
+#include "SqlStatements.h"
+#include "../models/UserRows.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+using namespace drogon::orm;
+
+namespace {
+
+// 分片数量
+const size_t SHARD_COUNT = 16;
+
+// 单条 IN 查询最多的ID数
+const size_t MAX_IDS_PER_QUERY = 500;
+
+using Snapshot = UserNameCache::Names;
+using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+/**
+ * 分片的只读视图：先查增量表，再查基础表
+ */
+struct View {
+    SnapshotPtr base;
+    SnapshotPtr delta;
+};
+
+using ViewPtr = std::shared_ptr<const View>;
+
+struct Shard {
+    std::mutex writeMutex;          // 只在写入时加锁
+    ViewPtr view = std::make_shared<View>(View{std::make_shared<Snapshot>(), std::make_shared<Snapshot>()});
+};
+
+// 任一分片写入后自增
+std::atomic<uint64_t> version{1};
+
+Shard& shardFor(int user_id) {
+    static Shard shards[SHARD_COUNT];
+    return shards[static_cast<unsigned int>(user_id) % SHARD_COUNT];
+}
+
+size_t shardIndex(int user_id) {
+    return static_cast<unsigned int>(user_id) % SHARD_COUNT;
+}
+
+size_t shardCapacity() {
+    static const size_t capacity = [] {
+        const auto& config = drogon::app().getCustomConfig()["user_name_cache"];
+        size_t maxUsers = config.get("max_users", 200000).asUInt64();
+        return std::max<size_t>(1, maxUsers / SHARD_COUNT);
+    }();
+    return capacity;
+}
+
+/**
+ * 增量表合并阈值：增量表复制 O(k)，合并均摊 O(n/k)，k 取 sqrt(n) 时两者相当
+ */
+size_t deltaLimit(size_t baseSize) {
+    return std::max<size_t>(32, static_cast<size_t>(std::sqrt(static_cast<double>(baseSize))));
+}
+
+/**
+ * 本线程持有的各分片视图
+ */
+struct LocalViews {
+    uint64_t version = 0;
+    ViewPtr views[SHARD_COUNT];
+};
+
+/**
+ * 取得分片的当前视图：版本未变时直接返回本线程缓存的指针
+ */
+const View& currentView(int user_id) {
+    thread_local LocalViews local;
+
+    uint64_t current = version.load(std::memory_order_acquire);
+    if (local.version != current) {
+        // 有写入：释放全部旧视图，用到时再获取
+        for (auto& view : local.views) {
+            view.reset();
+        }
+        local.version = current;
+    }
+
+    auto& view = local.views[shardIndex(user_id)];
+    if (!view) {
+        view = std::atomic_load(&shardFor(user_id).view);
+    }
+    return *view;
+}
+
+/**
+ * 合并后超出容量时淘汰约四分之一，保留本批写入的用户
+ */
+void evict(Snapshot& merged, const Snapshot& fresh) {
+    size_t capacity = shardCapacity();
+    if (merged.size() <= capacity) {
+        return;
+    }
+    size_t target = capacity - capacity / 4;
+    for (auto it = merged.begin(); it != merged.end() && merged.size() > target;) {
+        if (fresh.count(it->first)) {
+            ++it;
+        } else {
+            it = merged.erase(it);
+        }
+    }
+}
+
+std::string redisKey(int user_id) {
+    return "user:name:" + std::to_string(user_id);
+}
+
+/**
+ * 一次 resolve 调用中进行中的批量加载
+ */
+struct ResolveState {
+    UserNameCache::Names names;
+    UserNameCache::NamesCallback callback;
+    UserNameCache::ErrorCallback errorCallback;
+    std::mutex mutex;
+    size_t pending = 0;
+    bool failed = false;
+};
+
+/**
+ * 加载一批用户名
+ */
+void loadChunk(const RequestContextPtr& ctx, const DbClientPtr& client,
+               const std::shared_ptr<ResolveState>& state,
+               const int* ids, size_t count) {
+    sql::execInAsync(
+        ctx, client, sql::USER_NAMES_BY_IDS, ids, count,
+        [state](const Result& r) {
+            UserNameCache::Names loaded;
+            sql::forEachRow<models::UserNameRow>(r, [&loaded](models::UserNameRow&& row) {
+                loaded.emplace(row.id, std::move(row.username));
+            });
+            UserNameCache::putAll(loaded);
+
+            // 用户名不会修改，二级缓存不设过期时间（各条SET在连接上流水线执行）
+            for (const auto& entry : loaded) {
+                RedisCache::set(redisKey(entry.first), entry.second);
+            }
+
+            bool done;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->names.insert(loaded.begin(), loaded.end());
+                done = --state->pending == 0 && !state->failed;
+            }
+            if (done) {
+                state->callback(state->names);
+            }
+        },
+        [state](const DrogonDbException& e) {
+            bool first;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                --state->pending;
+                first = !state->failed;
+                state->failed = true;
+            }
+            if (first) {
+                state->errorCallback(e);
+            }
+        }
+    );
+}
+
+/**
+ * 分批从数据库加载（每批一条 IN 查询）
+ */
+void loadFromDb(const RequestContextPtr& ctx, const std::shared_ptr<ResolveState>& state,
+                const int* ids, size_t count) {
+    state->pending = (count + MAX_IDS_PER_QUERY - 1) / MAX_IDS_PER_QUERY;
+
+    auto dbClient = drogon::app().getDbClient();
+    for (size_t begin = 0; begin < count; begin += MAX_IDS_PER_QUERY) {
+        size_t end = std::min(count, begin + MAX_IDS_PER_QUERY);
+        loadChunk(ctx, dbClient, state, ids + begin, end - begin);
+    }
+}
+
+} // namespace
+
+bool UserNameCache::lookup(int user_id, std::string& username) {
+    const auto& view = currentView(user_id);
+    auto it = view.delta->find(user_id);
+    if (it == view.delta->end()) {
+        it = view.base->find(user_id);
+        if (it == view.base->end()) {
+            return false;
+        }
+    }
+    username = it->second;
+    return true;
+}
+
+void UserNameCache::put(int user_id, const std::string& username) {
+    Names names;
+    names.emplace(user_id, username);
+    putAll(names);
+}
+
+void UserNameCache::putAll(const Names& names) {
+    // 按分片归类，每个分片只复制一次
+    std::vector<const Names::value_type*> byShard[SHARD_COUNT];
+    for (const auto& entry : names) {
+        byShard[shardIndex(entry.first)].push_back(&entry);
+    }
+
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        if (byShard[i].empty()) {
+            continue;
+        }
+        auto& shard = shardFor(byShard[i].front()->first);
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+        auto current = std::atomic_load(&shard.view);
+        auto delta = std::make_shared<Snapshot>(*current->delta);
+        for (const auto* entry : byShard[i]) {
+            (*delta)[entry->first] = entry->second;
+        }
+
+        auto next = std::make_shared<View>(View{current->base, delta});
+        if (delta->size() > deltaLimit(current->base->size())) {
+            // 增量表合并进新的基础表
+            auto merged = std::make_shared<Snapshot>(*current->base);
+            for (const auto& entry : *delta) {
+                (*merged)[entry.first] = entry.second;
+            }
+            evict(*merged, *delta);
+            next->base = std::move(merged);
+            next->delta = std::make_shared<Snapshot>();
+        }
+
+        std::atomic_store(&shard.view, ViewPtr(std::move(next)));
+        version.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void UserNameCache::resolve(const RequestContextPtr& ctx, const std::pmr::vector<int>& user_ids,
+                            NamesCallback&& callback,
+                            ErrorCallback&& errorCallback) {
+    auto* resource = RequestContext::memoryResource(ctx);
+    std::pmr::vector<int> unique_ids(user_ids.begin(), user_ids.end(), resource);
+    std::sort(unique_ids.begin(), unique_ids.end());
+    unique_ids.erase(std::unique(unique_ids.begin(), unique_ids.end()), unique_ids.end());
+
+    auto state = std::make_shared<ResolveState>();
+    std::pmr::vector<int> missing(resource);
+    for (int user_id : unique_ids) {
+        std::string username;
+        if (lookup(user_id, username)) {
+            state->names.emplace(user_id, std::move(username));
+        } else {
+            missing.push_back(user_id);
+        }
+    }
+
+    if (missing.empty()) {
+        callback(state->names);
+        return;
+    }
+
+    state->callback = std::move(callback);
+    state->errorCallback = std::move(errorCallback);
+
+    if (!RedisCache::enabled()) {
+        loadFromDb(ctx, state, missing.data(), missing.size());
+        return;
+    }
+
+    // 先从二级缓存批量读取，仍缺少的再查数据库
+    std::vector<std::string> keys;
+    keys.reserve(missing.size());
+    for (int user_id : missing) {
+        keys.push_back(redisKey(user_id));
+    }
+    RedisCache::mget(
+        keys,
+        [ctx, state, ids = std::vector<int>(missing.begin(), missing.end())](
+            const std::vector<RedisCache::Value>& values) {
+            UserNameCache::Names cached;
+            std::vector<int> remaining;
+            for (size_t i = 0; i < ids.size(); i++) {
+                if (values[i]) {
+                    cached.emplace(ids[i], *values[i]);
+                } else {
+                    remaining.push_back(ids[i]);
+                }
+            }
+            UserNameCache::putAll(cached);
+
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->names.insert(cached.begin(), cached.end());
+            }
+            if (remaining.empty()) {
+                state->callback(state->names);
+                return;
+            }
+            loadFromDb(ctx, state, remaining.data(), remaining.size());
+        }
+    );
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "RequestContext.h"
+#include <drogon/orm/DbClient.h>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 用户ID → 用户名缓存
+ *
+ * 帖子列表、帖子详情、回复列表只为了作者用户名才 JOIN users 表。
+ * 用户名注册后不会修改，适合放在进程内缓存：查询只取 user_id，
+ * 用户名从缓存填充，未命中的ID用一条 IN 查询批量加载
+ *
+ * 设计要点：
+ * 1. 读多写少：按user_id分片，每个分片是一份只读视图（读-复制-更新），
+ *    视图由较大的基础表和较小的增量表组成。写入只复制增量表，
+ *    增量表超过约 sqrt(基础表大小) 时才合并进新的基础表，每次插入的复制量为 O(sqrt(n))
+ * 2. 无锁读：每个线程缓存各分片的视图指针，全局版本号未变时直接读本地指针，
+ *    不加锁也不修改引用计数；任一分片有写入时释放本线程持有的全部旧视图，按需重新获取，
+ *    旧的基础表不会被长期闲置的线程占住
+ * 3. 容量限制：合并时分片超过容量则淘汰约四分之一（不淘汰本批新写入的用户）
+ *    （custom_config.user_name_cache.max_users）
+ * 4. 启用 RedisCache 时，未命中的ID先用MGET从二级缓存批量读取，仍缺少的再查数据库，
+ *    查到后写回二级缓存
+ */
+class UserNameCache {
+public:
+    using Names = std::unordered_map<int, std::string>;
+    using NamesCallback = std::function<void(const Names& names)>;
+    using ErrorCallback = std::function<void(const drogon::orm::DrogonDbException&)>;
+
+    /**
+     * 批量获取用户名
+     * 全部命中时同步回调，否则先查二级缓存，再用 IN 查询加载仍未命中的ID
+     * @param ctx 请求上下文（加载时的数据库耗时计入该请求，临时数组使用请求内存池，可为空）
+     * @param callback 参数为ID到用户名的映射（不存在的用户不在其中）
+     */
+    static void resolve(const RequestContextPtr& ctx, const std::pmr::vector<int>& user_ids,
+                        NamesCallback&& callback,
+                        ErrorCallback&& errorCallback);
+
+    /**
+     * 只查缓存
+     * @return true=命中
+     */
+    static bool lookup(int user_id, std::string& username);
+
+    /**
+     * 写入缓存（注册、登录时已知用户名）
+     */
+    static void put(int user_id, const std::string& username);
+
+    /**
+     * 批量写入缓存（每个分片只复制一次增量表）
+     */
+    static void putAll(const Names& names);
+};
@@ -0,0 +1,312 @@
+#include "UsernameFilter.h"
+#include "SqlStatements.h"
+#include "../models/UserRows.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace drogon::orm;
+
+namespace {
+
+// 每次加载的用户数
+const int PAGE_SIZE = 10000;
+
+struct FilterConfig {
+    bool enabled;
+    uint64_t expectedUsers;
+    double falsePositiveRate;
+    double syncInterval;
+    double overlap;
+    double fullReload;
+};
+
+const FilterConfig& config() {
+    static const FilterConfig cfg = [] {
+        const auto& c = drogon::app().getCustomConfig()["username_filter"];
+        FilterConfig result;
+        result.enabled = c.get("enabled", true).asBool();
+        result.expectedUsers = std::max<uint64_t>(1000, c.get("expected_users", 1000000).asUInt64());
+        result.falsePositiveRate = std::min(0.5, std::max(1e-6, c.get("false_positive_rate", 0.01).asDouble()));
+        result.syncInterval = std::max(1.0, c.get("sync_interval_seconds", 5.0).asDouble());
+        result.overlap = std::max(1.0, c.get("overlap_seconds", 30.0).asDouble());
+        result.fullReload = std::max(result.overlap, c.get("full_reload_seconds", 3600.0).asDouble());
+        return result;
+    }();
+    return cfg;
+}
+
+/**
+ * 位数组和哈希函数个数（按配置一次性确定）
+ */
+struct Bloom {
+    uint64_t bitCount;
+    int hashCount;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+
+    Bloom() {
+        const auto& cfg = config();
+        double n = static_cast<double>(cfg.expectedUsers);
+        double bits = -n * std::log(cfg.falsePositiveRate) / (std::log(2.0) * std::log(2.0));
+        uint64_t wordCount = static_cast<uint64_t>(std::ceil(bits / 64));
+        bitCount = wordCount * 64;
+        hashCount = std::max(1, std::min(16, static_cast<int>(std::lround(bits / n * std::log(2.0)))));
+        words.reset(new std::atomic<uint64_t>[wordCount]());
+    }
+};
+
+Bloom& bloom() {
+    static Bloom instance;
+    return instance;
+}
+
+using Clock = std::chrono::steady_clock;
+using Waiter = std::function<void(bool)>;
+
+// 否定判定是否可信
+std::atomic<bool> loaded{false};
+
+/**
+ * 同步状态（只在主事件循环中访问）
+ */
+struct SyncState {
+    DbClientPtr client;
+    bool running = false;
+    bool full = false;              // 当前同步是否为全量加载
+    int maxId = 0;                  // 本轮同步读到的最大用户ID
+    // 每次同步完成时的 (最大用户ID, 完成时间)，用于确定重扫起点
+    std::deque<std::pair<int, Clock::time_point>> checkpoints;
+    Clock::time_point lastFullReload;
+    std::vector<Waiter> current;    // 等待本次同步的请求
+    std::vector<Waiter> next;       // 本次同步开始后到达的请求，等待下一次同步
+};
+
+SyncState& state() {
+    static SyncState instance;
+    return instance;
+}
+
+trantor::EventLoop* syncLoop() {
+    return drogon::app().getLoop();
+}
+
+/**
+ * 按数据库比较规则归一化：ASCII转小写，去掉末尾空格
+ * @return false=包含非ASCII字符（数据库可能按重音不敏感规则匹配，无法判断）
+ */
+bool normalize(const std::string& username, std::string& out) {
+    out.clear();
+    out.reserve(username.size());
+    for (char ch : username) {
+        auto c = static_cast<unsigned char>(ch);
+        if (c >= 0x80) {
+            return false;
+        }
+        out.push_back(static_cast<char>(std::tolower(c)));
+    }
+    while (!out.empty() && out.back() == ' ') {
+        out.pop_back();
+    }
+    return true;
+}
+
+/**
+ * 双重哈希：h_i = h1 + i * h2
+ */
+void hashPair(const std::string& key, uint64_t& h1, uint64_t& h2) {
+    h1 = std::hash<std::string>{}(key);
+    h2 = (h1 ^ (h1 >> 33)) * 0xff51afd7ed558ccdULL;
+    h2 = (h2 ^ (h2 >> 33)) | 1;
+}
+
+void insert(const std::string& normalized) {
+    auto& b = bloom();
+    uint64_t h1, h2;
+    hashPair(normalized, h1, h2);
+    for (int i = 0; i < b.hashCount; i++) {
+        uint64_t bit = (h1 + i * h2) % b.bitCount;
+        b.words[bit / 64].fetch_or(1ULL << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+bool contains(const std::string& normalized) {
+    auto& b = bloom();
+    uint64_t h1, h2;
+    hashPair(normalized, h1, h2);
+    for (int i = 0; i < b.hashCount; i++) {
+        uint64_t bit = (h1 + i * h2) % b.bitCount;
+        if (!(b.words[bit / 64].load(std::memory_order_relaxed) & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 增量同步的起点：overlap_seconds 之前完成的最近一次同步读到的最大id
+ * 在那之前分配但更晚提交的用户会在重扫中补上
+ */
+int rescanFrom() {
+    auto& s = state();
+    auto matured = Clock::now() - std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(config().overlap));
+    while (s.checkpoints.size() > 1 && s.checkpoints[1].second <= matured) {
+        s.checkpoints.pop_front();
+    }
+    return s.checkpoints.empty() ? 0 : s.checkpoints.front().first;
+}
+
+void finish(bool ok);
+
+/**
+ * 加载 id > afterId 的一页用户，满页时继续加载下一页
+ */
+void loadPage(int afterId) {
+    auto& s = state();
+    sql::execAsync(
+        nullptr, s.client, sql::USER_NAMES_AFTER,
+        [](const Result& r) {
+            std::vector<models::UserNameRow> rows;
+            rows.reserve(r.size());
+            sql::forEachRow<models::UserNameRow>(r, [&rows](models::UserNameRow&& row) {
+                rows.push_back(std::move(row));
+            });
+            bool more = r.size() == static_cast<size_t>(PAGE_SIZE);
+
+            syncLoop()->queueInLoop([rows = std::move(rows), more]() {
+                auto& s = state();
+                int lastId = 0;
+                for (const auto& row : rows) {
+                    UsernameFilter::add(row.username);
+                    lastId = std::max(lastId, row.id);
+                }
+                s.maxId = std::max(s.maxId, lastId);
+
+                if (more) {
+                    loadPage(lastId);
+                    return;
+                }
+                finish(true);
+            });
+        },
+        [](const DrogonDbException& e) {
+            LOG_WARN << "Username filter sync failed: " << e.base().what();
+            syncLoop()->queueInLoop([]() { finish(false); });
+        },
+        afterId, PAGE_SIZE
+    );
+}
+
+/**
+ * 开始一次同步（已有同步进行中时，等待中的请求留给下一次）
+ */
+void syncUsernames() {
+    auto& s = state();
+    if (s.running) {
+        return;
+    }
+    s.running = true;
+    s.current.swap(s.next);
+
+    auto now = Clock::now();
+    auto overlap = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config().overlap));
+    auto fullReload = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config().fullReload));
+    // 首次加载末尾可能漏掉提交较晚的用户，超过重扫窗口后再全量加载一次
+    bool firstMatured = !loaded.load(std::memory_order_relaxed) &&
+                        !s.checkpoints.empty() && s.checkpoints.front().second + overlap <= now;
+    s.full = s.checkpoints.empty() || firstMatured || now - s.lastFullReload >= fullReload;
+    int afterId = s.full ? 0 : rescanFrom();
+    s.maxId = afterId;
+    if (s.full) {
+        s.lastFullReload = now;
+    }
+    loadPage(afterId);
+}
+
+void finish(bool ok) {
+    auto& s = state();
+    s.running = false;
+
+    if (ok) {
+        if (s.checkpoints.empty()) {
+            const auto& b = bloom();
+            LOG_INFO << "Username filter loaded up to user id " << s.maxId << " ("
+                     << b.bitCount / 8 / 1024 << " KiB, " << b.hashCount << " hashes)";
+        } else if (s.full) {
+            // 第二次全量加载完成后，之前的检查点已超过重扫窗口，否定判定可信
+            loaded.store(true, std::memory_order_release);
+        }
+        s.checkpoints.emplace_back(s.maxId, Clock::now());
+    } else if (s.full) {
+        // 全量加载失败，下次重新开始
+        s.lastFullReload = Clock::time_point();
+    }
+
+    std::vector<Waiter> waiters;
+    waiters.swap(s.current);
+    for (auto& waiter : waiters) {
+        waiter(ok);
+    }
+
+    if (!s.next.empty()) {
+        syncUsernames();
+    }
+}
+
+} // namespace
+
+void UsernameFilter::start(const DbClientPtr& client) {
+    if (!config().enabled) {
+        return;
+    }
+
+    state().client = client;
+    syncLoop()->runInLoop([]() { syncUsernames(); });
+    syncLoop()->runEvery(config().syncInterval, []() {
+        syncUsernames();
+    });
+}
+
+void UsernameFilter::mightExist(const std::string& username, std::function<void(bool)>&& callback) {
+    if (!config().enabled || !loaded.load(std::memory_order_acquire)) {
+        callback(true);
+        return;
+    }
+
+    std::string normalized;
+    if (!normalize(username, normalized) || contains(normalized)) {
+        callback(true);
+        return;
+    }
+
+    // 位数组中没有：等一次在此之后开始的同步（其他进程刚注册的用户），再检查一次
+    syncLoop()->queueInLoop([normalized = std::move(normalized), callback = std::move(callback)]() mutable {
+        auto& s = state();
+        s.next.push_back([normalized = std::move(normalized), callback = std::move(callback)](bool ok) {
+            callback(!ok || contains(normalized));
+        });
+        syncUsernames();
+    });
+}
+
+void UsernameFilter::add(const std::string& username) {
+    if (!config().enabled) {
+        return;
+    }
+
+    std::string normalized;
+    if (normalize(username, normalized)) {
+        insert(normalized);
+    }
+}
+
+bool UsernameFilter::ready() {
+    return loaded.load(std::memory_order_acquire);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <functional>
+#include <string>
+
+/**
+ * 已注册用户名的布隆过滤器
+ *
+ * 登录时大量用户名并不存在（输错、撞库），每次都要查一次 users 表的索引。
+ * 过滤器判定"一定不存在"时直接返回用户不存在，不访问数据库；
+ * 判定"可能存在"时照常查询（误判率由配置决定，默认1%）
+ *
+ * 设计要点：
+ * 1. 启动时按id分页从 users 表加载全部用户名；之后按 sync_interval_seconds 增量加载，
+ *    每次从 overlap_seconds 之前同步到的最大id开始重扫，补上提交晚于更大id的用户；
+ *    每隔 full_reload_seconds 从头重新加载一次
+ * 2. 首次加载末尾可能漏掉提交较晚的用户，经过 overlap_seconds 后再全量加载一次，
+ *    完成前一律视为"可能存在"
+ * 3. 位数组判定不存在时不直接相信：用户可能刚在其他进程或实例注册。
+ *    等待一次在本次判定之后开始的同步完成后再检查，仍不存在才判定一定不存在，
+ *    同步失败时视为"可能存在"。等待中的请求共用同一次同步，数据库查询次数与请求量无关
+ * 4. 注册成功后立即加入；用户不会被删除，过滤器只增不减；位数组为原子变量，读写无锁
+ * 5. 用户名按数据库的比较规则归一化（忽略大小写和末尾空格）
+ *
+ * 配置（custom_config.username_filter）：
+ * - enabled: 是否启用（关闭时一律视为"可能存在"）
+ * - expected_users: 预期用户数，用于确定位数组大小
+ * - false_positive_rate: 目标误判率
+ * - sync_interval_seconds: 增量同步间隔
+ * - overlap_seconds: 增量同步重扫的时间窗口
+ * - full_reload_seconds: 全量重新加载间隔
+ */
+class UsernameFilter {
+public:
+    /**
+     * 开始加载并定期增量同步（启动时调用一次）
+     */
+    static void start(const drogon::orm::DbClientPtr& client);
+
+    /**
+     * 用户名是否可能存在
+     * 位数组命中或过滤器未就绪时立即回调；否则在下一次同步完成后回调
+     * @param callback false=一定不存在；true=可能存在
+     */
+    static void mightExist(const std::string& username, std::function<void(bool)>&& callback);
+
+    /**
+     * 加入一个用户名（注册成功后调用）
+     */
+    static void add(const std::string& username);
+
+    /**
+     * 否定判定是否可信（第二次全量加载已完成）
+     */
+    static bool ready();
+};
@@ -0,0 +1,137 @@
+#include "ViewCounter.h"
+#include "ErrorLogger.h"
+#include "ShardRouter.h"
+#include "SqlStatements.h"
+#include <drogon/drogon.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+using namespace drogon::orm;
+
+namespace {
+
+// 帖子ID -> 累计的访问次数
+using PendingViews = std::unordered_map<int, int>;
+
+// 快照只需要合计值
+uint64_t sumViews(const PendingViews& views) {
+    uint64_t total = 0;
+    for (const auto& item : views) {
+        total += static_cast<uint64_t>(item.second);
+    }
+    return total;
+}
+
+ShardRouter<PendingViews, uint64_t>& router() {
+    static ShardRouter<PendingViews, uint64_t> shards(sumViews);
+    return shards;
+}
+
+double flushInterval() {
+    static const double interval = std::max(
+        1.0, drogon::app().getCustomConfig()["view_counter"].get("flush_interval_seconds", 5.0).asDouble());
+    return interval;
+}
+
+DbClientPtr& dbClient() {
+    static DbClientPtr client;
+    return client;
+}
+
+/**
+ * 一次写回：每个分片和每条 UPDATE 各占一个计数，全部完成后调用 done
+ */
+struct FlushState {
+    std::atomic<size_t> pending;
+    std::function<void()> done;
+
+    void finishOne() {
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && done) {
+            done();
+        }
+    }
+};
+
+/**
+ * 写回全部累计的访问次数（各分片在自己的线程上取出并发起写回）
+ */
+void flushAll(std::function<void()>&& done) {
+    auto client = dbClient();
+    if (!client) {
+        if (done) {
+            done();
+        }
+        return;
+    }
+
+    auto state = std::make_shared<FlushState>();
+    state->pending = router().shardCount();
+    state->done = std::move(done);
+
+    router().forEach([client, state](PendingViews& pending) {
+        PendingViews views;
+        views.swap(pending);
+        state->pending.fetch_add(views.size(), std::memory_order_relaxed);
+
+        for (const auto& item : views) {
+            int post_id = item.first;
+            int count = item.second;
+            sql::execAsync(
+                nullptr, client, sql::POST_ADD_VIEWS,
+                [state](const Result& r) {
+                    state->finishOne();
+                },
+                [state, post_id, count](const DrogonDbException& e) {
+                    ErrorLogger::logBackgroundError("flush view count", e);
+                    // 加回，下次再写
+                    ViewCounter::add(post_id, count);
+                    state->finishOne();
+                },
+                count, post_id
+            );
+        }
+        state->finishOne();
+    });
+}
+
+} // namespace
+
+void ViewCounter::start(const DbClientPtr& client) {
+    dbClient() = client;
+    drogon::app().getLoop()->runEvery(flushInterval(), []() {
+        flushAll(nullptr);
+    });
+}
+
+void ViewCounter::add(int post_id, int views) {
+    router().update(post_id, [post_id, views](PendingViews& pending) {
+        pending[post_id] += views;
+    });
+}
+
+void ViewCounter::take(int post_id, std::function<void(int)>&& callback) {
+    router().update(post_id, [post_id, callback = std::move(callback)](PendingViews& pending) {
+        int views = 0;
+        auto it = pending.find(post_id);
+        if (it != pending.end()) {
+            views = it->second;
+            pending.erase(it);
+        }
+        callback(views);
+    });
+}
+
+void ViewCounter::flush(std::function<void()>&& done) {
+    flushAll(std::move(done));
+}
+
+uint64_t ViewCounter::pending() {
+    auto& shards = router();
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards.shardCount(); i++) {
+        total += *shards.snapshot(i);
+    }
+    return total;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <cstdint>
+#include <functional>
+
+/**
+ * 帖子浏览次数的内存累加器
+ *
+ * 帖子详情由响应缓存提供后，大部分请求不再访问数据库，浏览次数不能再每次请求写一次。
+ * 成功返回帖子详情的访问（帖子存在）只在内存中加一，由以下三处写回数据库（UPDATE ... + n）：
+ * 1. 详情重新加载时先写回该帖子累计的次数，再读取（读到的浏览次数包含这些访问）
+ * 2. 每隔 flush_interval_seconds 写回全部累计的次数
+ * 3. 收到 SIGTERM 退出前写回全部累计的次数
+ * 写回失败时次数加回累加器，下次再写
+ *
+ * 按帖子ID分片到IO线程（ShardRouter），计数只在所属线程上修改，不加锁
+ *
+ * 配置（custom_config.view_counter）：
+ * - flush_interval_seconds: 定期写回间隔
+ */
+class ViewCounter {
+public:
+    /**
+     * 开始定期写回（启动时调用一次）
+     */
+    static void start(const drogon::orm::DbClientPtr& client);
+
+    /**
+     * 记录访问（也用于加回写回失败的次数）
+     */
+    static void add(int post_id, int views = 1);
+
+    /**
+     * 取出并清零某个帖子累计的访问次数（调用方负责写回）
+     * @param callback 在帖子所属的IO线程上调用
+     */
+    static void take(int post_id, std::function<void(int)>&& callback);
+
+    /**
+     * 立即写回全部累计的次数
+     * @param done 全部写回完成（成功或失败）后调用一次
+     */
+    static void flush(std::function<void()>&& done);
+
+    /**
+     * 尚未写回的访问次数合计（读取各分片的快照，可在任意线程调用）
+     */
+    static uint64_t pending();
+};